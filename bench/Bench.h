@@ -0,0 +1,16 @@
+#pragma once
+
+#include <chrono>
+
+namespace wooden_axe::bench {
+
+// Each mode takes the arguments after its name and returns the process exit code
+int runPipeline(int argc, char** argv);
+int runUnpack(int argc, char** argv);
+int runBudgetTest(int argc, char** argv);
+
+inline double getElapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace wooden_axe::bench
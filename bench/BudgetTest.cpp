@@ -0,0 +1,162 @@
+#include "Bench.h"
+
+#include "mod/BudgetController.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+namespace wooden_axe::bench {
+
+namespace {
+
+// A server driven by a simulated clock: each tick does `otherMs` of game work plus the paste
+// slice, and the next tick starts targetMspt after this one unless the work ran longer
+class SimulatedServer {
+public:
+    explicit SimulatedServer(const BudgetSettings& settings)
+    : mSettings(settings),
+      mController(settings, [this] { return mNow; }) {}
+
+    double otherMs = 20.0;
+    double nsPerBlock = 500.0;
+
+    // One tick; returns the budget the controller handed out
+    size_t tick(size_t pendingBlocks = SIZE_MAX) {
+        auto tickStart = mNow;
+        size_t budget = mController.beginSlice();
+        size_t used = std::min(budget, pendingBlocks);
+        advance(static_cast<double>(used) * nsPerBlock / 1e6);
+        mController.endSlice(used);
+        advance(otherMs);
+
+        double elapsed = std::chrono::duration<double, std::milli>(mNow - tickStart).count();
+        if (elapsed < mSettings.targetMspt) {
+            advance(mSettings.targetMspt - elapsed);
+        }
+        return budget;
+    }
+
+    const BudgetController& getController() const { return mController; }
+
+private:
+    void advance(double ms) {
+        mNow += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(ms)
+        );
+    }
+
+    BudgetSettings mSettings;
+    std::chrono::steady_clock::time_point mNow{};
+    BudgetController mController;
+};
+
+int gFailures = 0;
+
+void check(bool condition, const char* what, double value) {
+    std::printf("  %-4s %s (%.1f)\n", condition ? "ok" : "FAIL", what, value);
+    if (!condition) {
+        gFailures++;
+    }
+}
+
+size_t runTicks(SimulatedServer& server, int ticks) {
+    size_t budget = 0;
+    for (int i = 0; i < ticks; i++) {
+        budget = server.tick();
+    }
+    return budget;
+}
+
+} // namespace
+
+int runBudgetTest(int /*argc*/, char** /*argv*/) {
+    BudgetSettings settings; // Config defaults: 50 ms target, 10 ms slices, 20000 blocks to start
+    gFailures = 0;
+
+    std::printf("steady load settles on maxSliceMs worth of blocks\n");
+    {
+        SimulatedServer server(settings);
+        size_t budget = runTicks(server, 50);
+        double expected = settings.maxSliceMs * 1e6 / server.nsPerBlock;
+        check(budget >= expected * 0.95 && budget <= expected * 1.05, "budget within 5% of 20000", budget);
+        check(server.getController().getSliceMs() <= settings.maxSliceMs * 1.05, "slice within maxSliceMs",
+              server.getController().getSliceMs());
+    }
+
+    std::printf("budget grows at most 2x per tick\n");
+    {
+        BudgetSettings slow = settings;
+        slow.initialBlocks = slow.minBlocks;
+        SimulatedServer server(slow);
+        server.nsPerBlock = 50.0;
+        double worstGrowth = 0.0;
+        size_t previous = server.tick();
+        for (int i = 0; i < 30; i++) {
+            size_t budget = server.tick();
+            worstGrowth = std::max(worstGrowth, static_cast<double>(budget) / static_cast<double>(previous));
+            previous = budget;
+        }
+        check(worstGrowth <= 2.0, "largest tick-to-tick growth <= 2x", worstGrowth);
+        check(previous == slow.maxBlocks, "reaches maxBlocks on cheap blocks", previous);
+    }
+
+    std::printf("a lag spike cuts the slice at once and it recovers afterwards\n");
+    {
+        SimulatedServer server(settings);
+        size_t steady = runTicks(server, 50);
+        server.otherMs = 70.0; // Over target without any paste work
+        server.tick();
+        size_t cut = server.tick();
+        check(cut == settings.minBlocks, "budget at minBlocks the tick after the overrun", cut);
+        server.otherMs = 20.0;
+        size_t recovered = runTicks(server, 20);
+        check(recovered >= steady * 0.95, "back within 5% of steady 20 ticks later", recovered);
+    }
+
+    std::printf("heavy game load: slices shrink until ticks fit targetMspt\n");
+    {
+        SimulatedServer server(settings);
+        server.otherMs = 45.0;
+        runTicks(server, 50);
+        double worstTick = 0.0;
+        double totalTick = 0.0;
+        for (int i = 0; i < 50; i++) {
+            server.tick();
+            worstTick = std::max(worstTick, server.getController().getTickMs());
+            totalTick += server.getController().getTickMs();
+        }
+        check(totalTick / 50 <= settings.targetMspt * 1.02, "mean tick within 2% of targetMspt", totalTick / 50);
+        check(worstTick <= settings.targetMspt + 2.0, "no tick over target by more than 2 ms", worstTick);
+    }
+
+    std::printf("block cost doubling halves the budget\n");
+    {
+        SimulatedServer server(settings);
+        runTicks(server, 50);
+        server.nsPerBlock = 1000.0;
+        size_t budget = runTicks(server, 30);
+        double expected = settings.maxSliceMs * 1e6 / server.nsPerBlock;
+        check(budget >= expected * 0.95 && budget <= expected * 1.05, "budget within 5% of 10000", budget);
+    }
+
+    std::printf("idle ticks leave the budget alone\n");
+    {
+        SimulatedServer server(settings);
+        size_t before = runTicks(server, 50);
+        size_t after = before;
+        for (int i = 0; i < 20; i++) {
+            after = server.tick(0);
+        }
+        check(after == before, "unchanged after 20 idle ticks", after);
+    }
+
+    if (gFailures == 0) {
+        std::printf("all checks passed\n");
+    } else {
+        std::printf("%d check(s) failed\n", gFailures);
+    }
+    return gFailures == 0 ? 0 : 1;
+}
+
+} // namespace wooden_axe::bench
@@ -0,0 +1,62 @@
+#include "HeapCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace wooden_axe::bench {
+
+namespace {
+
+std::atomic<size_t> gAllocations{0};
+std::atomic<size_t> gBytes{0};
+
+void* allocate(size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* allocateAligned(size_t size, size_t alignment) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef _WIN32
+    void* p = _aligned_malloc(size ? size : 1, alignment);
+#else
+    void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void freeAligned(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+HeapCounts getHeapCounts() {
+    return {gAllocations.load(std::memory_order_relaxed), gBytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace wooden_axe::bench
+
+// Array and nothrow forms forward to these by default
+void* operator new(size_t size) { return wooden_axe::bench::allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return wooden_axe::bench::allocateAligned(size, static_cast<size_t>(alignment));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { wooden_axe::bench::freeAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { wooden_axe::bench::freeAligned(p); }
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace wooden_axe::bench {
+
+// Global operator new calls since the program started; the bench replaces the global allocator
+// functions to count them
+struct HeapCounts {
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+    HeapCounts operator-(const HeapCounts& earlier) const {
+        return {allocations - earlier.allocations, bytes - earlier.bytes};
+    }
+};
+
+HeapCounts getHeapCounts();
+
+} // namespace wooden_axe::bench
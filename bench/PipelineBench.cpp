@@ -0,0 +1,313 @@
+#include "Bench.h"
+#include "HeapCounter.h"
+
+#include "mod/Config.h"
+#include "mod/JobScheduler.h"
+#include "mod/MemoryWorldSink.h"
+#include "mod/ParseArena.h"
+#include "mod/PasteJob.h"
+#include "mod/PlacementPlan.h"
+#include "mod/SchematicReader.h"
+#include "mod/WorkerPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+
+namespace wooden_axe::bench {
+
+namespace {
+
+// Interned names instead of registry lookups; air stays air, like SchematicPlacer::resolvePalette
+ResolvedPalette resolvePalette(const Schematic& schem, MemoryWorldSink& sink) {
+    ResolvedPalette resolved;
+    resolved.blocks.resize(schem.palette.size(), nullptr);
+    resolved.kinds.resize(schem.palette.size(), PaletteEntryKind::Place);
+    for (size_t i = 0; i < schem.palette.size(); i++) {
+        if (schem.palette[i].isAir()) {
+            resolved.kinds[i] = PaletteEntryKind::Air;
+        } else {
+            resolved.blocks[i] = sink.resolveBlock(schem.palette[i].toString());
+        }
+    }
+    return resolved;
+}
+
+struct PasteRun {
+    PlaceResult result;
+    size_t ticks = 0;
+};
+
+// The plan written by a real PasteJob, queued on a scheduler of its own that is ticked back to
+// back until the job is done; budget and paste options come from `config`
+PasteRun runPasteJob(std::shared_ptr<const PlacementPlan> plan, std::shared_ptr<MemoryWorldSink> sink,
+                     const Config& config) {
+    PasteRun run;
+    JobScheduler scheduler;
+    scheduler.start(makeSchedulerSettings(config));
+    auto job = std::make_shared<PasteJob>(
+        sink, "bench paste", makePasteOptions(config), [&run](const PlaceResult& result) { run.result = result; }
+    );
+    scheduler.submit(job, "bench");
+    job->addPlan(std::move(plan), true);
+    while (job->isActive()) {
+        scheduler.tick();
+        run.ticks++;
+    }
+    scheduler.stop();
+    return run;
+}
+
+// Expand every section into one flat grid (index = (y * length + z) * width + x)
+std::vector<int> expandBlocks(const Schematic& schem) {
+    const auto& blocks = schem.blocks;
+    std::vector<int> grid(schem.getBlockCount());
+    int values[SectionedBlocks::kVolume];
+    for (int sectionY = 0; sectionY < blocks.getSectionsY(); sectionY++) {
+        for (int sectionZ = 0; sectionZ < blocks.getSectionsZ(); sectionZ++) {
+            for (int sectionX = 0; sectionX < blocks.getSectionsX(); sectionX++) {
+                blocks.decode(blocks.getSectionIndex(sectionX, sectionY, sectionZ), values);
+                for (int y = 0; y < 16 && sectionY * 16 + y < schem.height; y++) {
+                    for (int z = 0; z < 16 && sectionZ * 16 + z < schem.length; z++) {
+                        for (int x = 0; x < 16 && sectionX * 16 + x < schem.width; x++) {
+                            size_t index = (static_cast<size_t>(sectionY * 16 + y) * schem.length + sectionZ * 16 + z)
+                                             * schem.width
+                                         + sectionX * 16 + x;
+                            grid[index] = values[(y * 16 + z) * 16 + x];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+// Reads through SectionedBlocks::get (and its decoded-section cache), section by section and at
+// random, against the same reads from a flat grid; false if any read disagrees
+bool compareReads(const Schematic& schem, const std::vector<int>& grid) {
+    const auto& blocks = schem.blocks;
+    auto flatIndex = [&](int x, int y, int z) { return (static_cast<size_t>(y) * schem.length + z) * schem.width + x; };
+
+    size_t mismatches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int sectionY = 0; sectionY < blocks.getSectionsY(); sectionY++) {
+        for (int sectionZ = 0; sectionZ < blocks.getSectionsZ(); sectionZ++) {
+            for (int sectionX = 0; sectionX < blocks.getSectionsX(); sectionX++) {
+                int maxY = std::min(schem.height, sectionY * 16 + 16);
+                int maxZ = std::min(schem.length, sectionZ * 16 + 16);
+                int maxX = std::min(schem.width, sectionX * 16 + 16);
+                for (int y = sectionY * 16; y < maxY; y++) {
+                    for (int z = sectionZ * 16; z < maxZ; z++) {
+                        for (int x = sectionX * 16; x < maxX; x++) {
+                            mismatches += blocks.get(x, y, z) != grid[flatIndex(x, y, z)];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    double orderedMs = getElapsedMs(start);
+
+    std::mt19937 random(12345);
+    size_t reads = std::min<size_t>(grid.size(), 65536);
+    std::vector<std::array<int, 3>> positions(reads);
+    for (auto& position : positions) {
+        position = {static_cast<int>(random() % schem.width), static_cast<int>(random() % schem.height),
+                    static_cast<int>(random() % schem.length)};
+    }
+    start = std::chrono::steady_clock::now();
+    for (const auto& [x, y, z] : positions) {
+        mismatches += blocks.get(x, y, z) != grid[flatIndex(x, y, z)];
+    }
+    double randomMs = getElapsedMs(start);
+
+    std::printf("reads    %9.1f ns per voxel in section order, %.1f ns at random (%zu reads)\n",
+                orderedMs * 1e6 / grid.size(), randomMs * 1e6 / reads, reads);
+    return mismatches == 0;
+}
+
+// The same schematic with every non-uniform section holding its own copy of its bytes, so
+// buildPlacementPlan finds no repeats to compile once
+Schematic makeUnshared(const Schematic& schem) {
+    const auto& data = schem.blocks.getData();
+    std::vector<SectionedBlocks::Section> sections = schem.blocks.getSections();
+    std::vector<uint8_t> copied;
+    for (auto& section : sections) {
+        if (section.kind != SectionedBlocks::Kind::Uniform) {
+            uint64_t offset = copied.size();
+            copied.insert(copied.end(), data.begin() + section.offset, data.begin() + section.offset + section.size);
+            section.offset = offset;
+        }
+    }
+    Schematic unshared = schem;
+    unshared.blocks =
+        SectionedBlocks::fromSections(schem.width, schem.height, schem.length, std::move(sections), std::move(copied));
+    return unshared;
+}
+
+bool isSamePlan(const PlacementPlan& a, const PlacementPlan& b) {
+    if (a.blocks != b.blocks || a.chunks.size() != b.chunks.size() || a.skipped != b.skipped
+        || a.failed != b.failed) {
+        return false;
+    }
+    for (size_t i = 0; i < a.chunks.size(); i++) {
+        const auto& chunkA = a.chunks[i];
+        const auto& chunkB = b.chunks[i];
+        if (chunkA.chunkX != chunkB.chunkX || chunkA.chunkZ != chunkB.chunkZ
+            || chunkA.commands.size() != chunkB.commands.size()) {
+            return false;
+        }
+        for (size_t k = 0; k < chunkA.commands.size(); k++) {
+            if (chunkA.commands[k].packedPos != chunkB.commands[k].packedPos
+                || chunkA.commands[k].blockIndex != chunkB.commands[k].blockIndex) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Blocks in the sink that differ from what the plan asked for
+size_t countMismatches(const PlacementPlan& plan, const MemoryWorldSink& sink) {
+    size_t mismatches = 0;
+    for (const auto& chunk : plan.chunks) {
+        for (const auto& command : chunk.commands) {
+            const Block* block = sink.peekBlock(chunk.chunkX * 16 + command.localX(), command.worldY(),
+                                                chunk.chunkZ * 16 + command.localZ());
+            if (block != plan.blocks[command.blockIndex]) {
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int runPipeline(int argc, char** argv) {
+    if (argc < 1) {
+        std::fprintf(stderr, "pipeline: missing schematic path\n");
+        return 2;
+    }
+    std::string path = argv[0];
+    int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+    size_t loadDelay = argc > 2 ? static_cast<size_t>(std::max(0, std::atoi(argv[2]))) : 0;
+    Config config;
+
+    WorkerPool::getInstance().start();
+    std::printf("%zu worker threads, %d repeats, chunk load delay %zu polls\n",
+                WorkerPool::getInstance().getThreadCount(), repeats, loadDelay);
+
+    // Loads are repeated too; the last one is kept, counted and planned
+    std::optional<Schematic> schem;
+    ParseStats stats;
+    HeapCounts heap;
+    double bestLoadMs = 0.0;
+    double bestParseMs = 0.0;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        schem.reset();
+        stats = {};
+        HeapCounts before = getHeapCounts();
+        auto start = std::chrono::steady_clock::now();
+        schem = SchematicReader::loadFromFile(path, &stats);
+        double loadMs = getElapsedMs(start);
+        heap = getHeapCounts() - before;
+        if (!schem) {
+            std::fprintf(stderr, "pipeline: failed to load %s\n", path.c_str());
+            WorkerPool::getInstance().stop();
+            return 1;
+        }
+        bestLoadMs = repeat == 0 ? loadMs : std::min(bestLoadMs, loadMs);
+        bestParseMs = repeat == 0 ? stats.parseMs : std::min(bestParseMs, stats.parseMs);
+    }
+    std::printf("load     %9.2f ms  (parse %.2f ms)  %dx%dx%d, %zu palette entries\n", bestLoadMs, bestParseMs,
+                schem->width, schem->height, schem->length, schem->palette.size());
+    std::printf("heap     %9zu allocations (%zu KB) per load\n", heap.allocations, heap.bytes / 1024);
+    std::printf("arena    %9zu allocations (%zu KB) served from %zu heap blocks (%zu KB)\n", stats.arenaAllocations,
+                stats.arenaBytes / 1024, stats.upstreamBlocks, stats.upstreamBytes / 1024);
+    std::printf("blocks   %9zu KB resident, %zu KB as a flat array\n", schem->blocks.getMemoryUsage() / 1024,
+                schem->getBlockCount() * sizeof(int) / 1024);
+
+    size_t kinds[3] = {};
+    for (const auto& section : schem->blocks.getSections()) {
+        kinds[static_cast<size_t>(section.kind)]++;
+    }
+    std::printf("sections %9zu: %zu uniform, %zu packed, %zu deflated\n", schem->blocks.getSectionCount(), kinds[0],
+                kinds[1], kinds[2]);
+
+    int exitCode = 0;
+    if (!schem->blocks.empty()) {
+        auto grid = expandBlocks(*schem);
+        if (!compareReads(*schem, grid)) {
+            std::fprintf(stderr, "pipeline: section reads differ from the decoded sections\n");
+            exitCode = 1;
+        }
+    }
+
+    // Plans are also built from a copy without shared sections, to show what sharing saves
+    Schematic unshared = makeUnshared(*schem);
+    size_t nonUniform = kinds[1] + kinds[2];
+    std::printf("shared   %9zu distinct of %zu non-uniform sections, %zu KB unshared\n",
+                schem->blocks.getStoredSectionCount(), nonUniform, unshared.blocks.getMemoryUsage() / 1024);
+
+    // Best of `repeats`; every repeat writes into a fresh world and is checked against its plan
+    double bestPlanMs = 0.0;
+    double bestUnsharedMs = 0.0;
+    double bestWriteMs = 0.0;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        auto sink = std::make_shared<MemoryWorldSink>(loadDelay);
+        auto palette = resolvePalette(*schem, *sink);
+
+        auto start = std::chrono::steady_clock::now();
+        auto plan = std::make_shared<const PlacementPlan>(buildPlacementPlan(*schem, palette, 0, 0, 0));
+        double planMs = getElapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        auto unsharedPlan = buildPlacementPlan(unshared, palette, 0, 0, 0);
+        double unsharedMs = getElapsedMs(start);
+        if (!isSamePlan(*plan, unsharedPlan)) {
+            std::fprintf(stderr, "pipeline: repeat %d planned differently without shared sections\n", repeat);
+            exitCode = 1;
+        }
+
+        start = std::chrono::steady_clock::now();
+        auto run = runPasteJob(plan, sink, config);
+        double writeMs = getElapsedMs(start);
+
+        bestPlanMs = repeat == 0 ? planMs : std::min(bestPlanMs, planMs);
+        bestUnsharedMs = repeat == 0 ? unsharedMs : std::min(bestUnsharedMs, unsharedMs);
+        bestWriteMs = repeat == 0 ? writeMs : std::min(bestWriteMs, writeMs);
+
+        if (repeat == 0) {
+            const auto& sinkStats = sink->getStats();
+            std::printf("plan     %9zu commands in %zu chunks, %zu skipped, %zu failed\n", plan->getCommandCount(),
+                        plan->chunks.size(), plan->skipped, plan->failed);
+            std::printf("write    %9zu placed (%zu in %zu whole sections), %zu subchunk refreshes, %zu ticks\n",
+                        run.result.placed, sinkStats.sectionWrites * ChunkCommandBuffer::kSectionVolume,
+                        sinkStats.sectionWrites, run.result.refreshedSubchunks, run.ticks);
+        }
+
+        size_t mismatches = countMismatches(*plan, *sink);
+        if (!run.result.ok || run.result.placed != plan->getCommandCount() || mismatches > 0) {
+            std::fprintf(stderr, "pipeline: repeat %d placed %zu of %zu commands, %zu blocks differ from the plan\n",
+                         repeat, run.result.placed, plan->getCommandCount(), mismatches);
+            exitCode = 1;
+        }
+    }
+
+    size_t voxels = schem->getBlockCount();
+    std::printf("best     %9.2f ms plan, %.2f ms write (%.1f M voxels/s end to end)\n", bestPlanMs, bestWriteMs,
+                bestPlanMs + bestWriteMs > 0.0 ? voxels / ((bestPlanMs + bestWriteMs) * 1000.0) : 0.0);
+    std::printf("         %9.2f ms plan without shared sections\n", bestUnsharedMs);
+
+    WorkerPool::getInstance().stop();
+    return exitCode;
+}
+
+} // namespace wooden_axe::bench
@@ -0,0 +1,80 @@
+#include "Bench.h"
+
+#include "mod/BitUnpack.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace wooden_axe::bench {
+
+namespace {
+
+// Pack `values` LSB-first at `bits` per entry, straddling words, plus the padding word
+std::vector<uint64_t> packValues(const std::vector<int>& values, int bits) {
+    size_t wordCount = (values.size() * bits + 63) / 64;
+    std::vector<uint64_t> words(wordCount + 1, 0);
+    for (size_t i = 0; i < values.size(); i++) {
+        size_t bit = i * bits;
+        auto value = static_cast<uint64_t>(values[i]);
+        words[bit / 64] |= value << (bit % 64);
+        if (bit % 64 + bits > 64) {
+            words[bit / 64 + 1] |= value >> (64 - bit % 64);
+        }
+    }
+    return words;
+}
+
+template <typename Fn>
+double timeBest(int repeats, Fn&& fn) {
+    double best = 0.0;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double elapsed = getElapsedMs(start);
+        best = repeat == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+} // namespace
+
+int runUnpack(int argc, char** argv) {
+    size_t count = argc > 0 ? static_cast<size_t>(std::max(1, std::atoi(argv[0]))) * 1024 * 1024 : 64 * 1024 * 1024;
+    int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+    std::printf("%zu M entries, best of %d, vectorized path %s\n", count / (1024 * 1024), repeats,
+                hasVectorizedUnpack() ? "available" : "not available");
+
+    std::mt19937 random(12345);
+    std::vector<int> values(count);
+    std::vector<int> scalar(count);
+    std::vector<int> unpacked(count);
+    int exitCode = 0;
+
+    // Palette sizes 2..4096: from small builds to large terrain
+    for (int bits : {2, 4, 5, 7, 9, 12}) {
+        std::uniform_int_distribution<int> entry(0, (1 << bits) - 1);
+        std::generate(values.begin(), values.end(), [&] { return entry(random); });
+        auto words = packValues(values, bits);
+        size_t wordCount = words.size() - 1;
+
+        double scalarMs = timeBest(repeats, [&] {
+            unpackBitArrayScalar(words.data(), wordCount, bits, 0, count, scalar.data());
+        });
+        double unpackMs = timeBest(repeats, [&] {
+            unpackBitArray(words.data(), wordCount, bits, count, unpacked.data());
+        });
+
+        bool ok = scalar == values && unpacked == values;
+        std::printf("%2d bits  scalar %8.2f ms  unpackBitArray %8.2f ms  %.2fx  %s\n", bits, scalarMs, unpackMs,
+                    unpackMs > 0.0 ? scalarMs / unpackMs : 0.0, ok ? "ok" : "MISMATCH");
+        if (!ok) {
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
+
+} // namespace wooden_axe::bench
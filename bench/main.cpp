@@ -0,0 +1,50 @@
+#include "Bench.h"
+
+#include "mod/Log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Mode {
+    const char* name;
+    const char* usage;
+    int (*run)(int argc, char** argv);
+};
+
+constexpr Mode kModes[] = {
+    {"pipeline", "pipeline <schematic> [repeats] [chunk load delay]", wooden_axe::bench::runPipeline},
+    {"unpack", "unpack [M entries] [repeats]", wooden_axe::bench::runUnpack},
+    {"budget", "budget", wooden_axe::bench::runBudgetTest},
+};
+
+int printUsage() {
+    std::fprintf(stderr, "usage:\n");
+    for (const auto& mode : kModes) {
+        std::fprintf(stderr, "  wooden-axe-bench %s\n", mode.usage);
+    }
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return printUsage();
+    }
+
+    // The modes print their own results; only problems are worth showing from the mod code
+    wooden_axe::Log::setHandler([](wooden_axe::LogLevel level, const std::string& message) {
+        if (level == wooden_axe::LogLevel::Warn || level == wooden_axe::LogLevel::Error) {
+            std::fprintf(stderr, "%s\n", message.c_str());
+        }
+    });
+    for (const auto& mode : kModes) {
+        if (std::strcmp(argv[1], mode.name) == 0) {
+            return mode.run(argc - 2, argv + 2);
+        }
+    }
+    return printUsage();
+}
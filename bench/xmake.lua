@@ -0,0 +1,45 @@
+-- Off-server harness for the parts of the plugin that do not need a server:
+-- schematic loading, plan building and a PasteJob writing into MemoryWorldSink.
+-- Builds with any C++20 compiler, Linux included:
+--   xmake -P bench
+--   xmake run -P bench wooden-axe-bench pipeline <file.schem|file.litematic>
+--   xmake test -P bench
+add_rules("mode.release", "mode.debug")
+set_defaultmode("release")
+
+add_requires("zlib", "fmt")
+
+target("wooden-axe-bench")
+    set_kind("binary")
+    set_languages("c++20")
+    add_packages("zlib", "fmt")
+    add_includedirs("../src")
+    add_files("*.cpp")
+    add_files(
+        "../src/mod/BitUnpack.cpp",
+        "../src/mod/BlockEntities.cpp",
+        "../src/mod/BudgetController.cpp",
+        "../src/mod/ChunkPreloader.cpp",
+        "../src/mod/JobScheduler.cpp",
+        "../src/mod/Log.cpp",
+        "../src/mod/MemoryWorldSink.cpp",
+        "../src/mod/Nbt.cpp",
+        "../src/mod/PasteJob.cpp",
+        "../src/mod/PasteMask.cpp",
+        "../src/mod/PlacementPlan.cpp",
+        "../src/mod/SchematicReader.cpp",
+        "../src/mod/SchematicStream.cpp",
+        "../src/mod/SectionedBlocks.cpp",
+        "../src/mod/Trace.cpp",
+        "../src/mod/WorkerPool.cpp",
+        "../src/mod/WorldSink.cpp"
+    )
+    if is_plat("windows") then
+        add_cxflags("/EHsc", "/utf-8", "/W4")
+        add_defines("NOMINMAX")
+    else
+        add_cxflags("-Wall", "-Wextra")
+        add_syslinks("pthread")
+    end
+    -- xmake test -P bench
+    add_tests("budget", {runargs = "budget"})
@@ -0,0 +1,135 @@
+#include "mod/BitUnpack.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#    define WA_HAS_X64 1
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#        define WA_TARGET_AVX2
+#    else
+#        define WA_TARGET_AVX2 __attribute__((target("avx2")))
+#    endif
+#else
+#    define WA_HAS_X64 0
+#endif
+
+namespace wooden_axe {
+
+int litematicaBitsPerEntry(size_t paletteSize) {
+    int bits = 0;
+    size_t maxValue = paletteSize > 0 ? paletteSize - 1 : 0;
+    while (maxValue > 0) {
+        bits++;
+        maxValue >>= 1;
+    }
+    return bits < 2 ? 2 : bits;
+}
+
+void unpackBitArrayScalar(const uint64_t* words, size_t wordCount, int bits, size_t begin, size_t count, int* out) {
+    uint64_t mask = (uint64_t{1} << bits) - 1;
+    for (size_t i = begin; i < count; i++) {
+        uint64_t bitPos = static_cast<uint64_t>(i) * bits;
+        size_t word = static_cast<size_t>(bitPos >> 6);
+        unsigned shift = static_cast<unsigned>(bitPos & 63);
+        if (word >= wordCount) {
+            out[i] = 0;
+            continue;
+        }
+
+        uint64_t value = words[word] >> shift;
+        if (shift + bits > 64) {
+            value |= words[word + 1] << (64 - shift);
+        }
+        out[i] = static_cast<int>(value & mask);
+    }
+}
+
+#if WA_HAS_X64
+
+// Four values per iteration: gather the low/high words for each lane, then
+// variable-shift and mask. sllv by 64 yields zero, so lanes that do not
+// straddle a word need no special casing.
+WA_TARGET_AVX2 static size_t unpackBitArrayAvx2(const uint64_t* words, size_t wordCount, int bits, size_t count,
+                                               int* out) {
+    // Stop where the high-word gather of the last lane would leave the padded buffer
+    size_t safeCount = (wordCount * 64) / bits;
+    if (safeCount > count) {
+        safeCount = count;
+    }
+    safeCount &= ~size_t{3};
+
+    const auto* base = reinterpret_cast<const long long*>(words);
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>((uint64_t{1} << bits) - 1));
+    const __m256i laneOffsets = _mm256_set_epi64x(3LL * bits, 2LL * bits, bits, 0);
+    const __m256i bitStep = _mm256_set1_epi64x(4LL * bits);
+    const __m256i low6 = _mm256_set1_epi64x(63);
+    const __m256i sixtyFour = _mm256_set1_epi64x(64);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i packLow = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+
+    __m256i bitPos = laneOffsets;
+    for (size_t i = 0; i < safeCount; i += 4) {
+        __m256i word = _mm256_srli_epi64(bitPos, 6);
+        __m256i shift = _mm256_and_si256(bitPos, low6);
+
+        __m256i lo = _mm256_i64gather_epi64(base, word, 8);
+        __m256i hi = _mm256_i64gather_epi64(base, _mm256_add_epi64(word, one), 8);
+
+        __m256i value = _mm256_or_si256(
+            _mm256_srlv_epi64(lo, shift),
+            _mm256_sllv_epi64(hi, _mm256_sub_epi64(sixtyFour, shift))
+        );
+        value = _mm256_and_si256(value, mask);
+
+        __m256i packed = _mm256_permutevar8x32_epi32(value, packLow);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+
+        bitPos = _mm256_add_epi64(bitPos, bitStep);
+    }
+    return safeCount;
+}
+
+static bool detectAvx2() {
+#    ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#    else
+    return __builtin_cpu_supports("avx2");
+#    endif
+}
+
+bool hasVectorizedUnpack() {
+    static const bool supported = detectAvx2();
+    return supported;
+}
+
+#else
+
+bool hasVectorizedUnpack() {
+    return false;
+}
+
+#endif
+
+void unpackBitArray(const uint64_t* words, size_t wordCount, int bits, size_t count, int* out) {
+    if (bits <= 0 || bits > 32 || count == 0) {
+        return;
+    }
+
+    size_t done = 0;
+#if WA_HAS_X64
+    if (hasVectorizedUnpack()) {
+        done = unpackBitArrayAvx2(words, wordCount, bits, count, out);
+    }
+#endif
+    unpackBitArrayScalar(words, wordCount, bits, done, count, out);
+}
+
+} // namespace wooden_axe
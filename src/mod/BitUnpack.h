@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace wooden_axe {
+
+// Number of bits needed per entry for a Litematica palette of the given size
+int litematicaBitsPerEntry(size_t paletteSize);
+
+// Decode `count` fixed-width values packed LSB-first into 64-bit words.
+// Values may straddle two words (Litematica's LitematicaBitArray layout).
+// `words` must be padded with one extra word after the last data word.
+void unpackBitArray(const uint64_t* words, size_t wordCount, int bits, size_t count, int* out);
+
+// Reference implementation, also used for the tail of the vectorized path
+void unpackBitArrayScalar(const uint64_t* words, size_t wordCount, int bits, size_t begin, size_t count, int* out);
+
+// True when the AVX2 path is compiled in and supported by this CPU
+bool hasVectorizedUnpack();
+
+} // namespace wooden_axe
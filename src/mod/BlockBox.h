@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+namespace wooden_axe {
+
+struct BlockPos {
+    int x, y, z;
+    BlockPos(int x = 0, int y = 0, int z = 0) : x(x), y(y), z(z) {}
+};
+
+// Inclusive axis-aligned block box
+struct BlockBox {
+    BlockPos min;
+    BlockPos max;
+    
+    size_t getVolume() const {
+        return static_cast<size_t>(max.x - min.x + 1) * (max.y - min.y + 1) * (max.z - min.z + 1);
+    }
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,507 @@
+#include "mod/BlockEntities.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+
+namespace wooden_axe {
+
+namespace {
+
+constexpr int kMaxCoordinate = 0x1FFFFF;
+
+int32_t readInt32(const uint8_t* data) {
+    return static_cast<int32_t>(
+        (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16)
+        | (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3])
+    );
+}
+
+std::string_view stripNamespace(std::string_view id) {
+    auto colon = id.find(':');
+    return colon == std::string_view::npos ? id : id.substr(colon + 1);
+}
+
+int64_t getInt(const NbtNode& node, std::string_view key, int64_t fallback) {
+    const NbtNode* child = node.find(key);
+    if (!child) {
+        return fallback;
+    }
+    switch (child->type) {
+    case TagType::Byte:
+    case TagType::Short:
+    case TagType::Int:
+    case TagType::Long:
+        return child->intValue;
+    default:
+        return fallback;
+    }
+}
+
+std::string getString(const NbtNode& node, std::string_view key) {
+    const NbtNode* child = node.find(key);
+    return child && child->type == TagType::String ? child->stringValue : std::string();
+}
+
+void appendUtf8(std::string& out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out.push_back(static_cast<char>(codepoint));
+    } else if (codepoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+// Parse a JSON string literal starting at text[pos] == '"'
+std::string parseJsonString(std::string_view text, size_t& pos) {
+    std::string out;
+    pos++; // Opening quote
+    while (pos < text.size() && text[pos] != '"') {
+        char c = text[pos++];
+        if (c != '\\' || pos >= text.size()) {
+            out.push_back(c);
+            continue;
+        }
+        char escaped = text[pos++];
+        switch (escaped) {
+        case 'n':
+            out.push_back('\n');
+            break;
+        case 't':
+            out.push_back('\t');
+            break;
+        case 'u':
+            if (pos + 4 <= text.size()) {
+                uint32_t codepoint = 0;
+                for (int i = 0; i < 4; i++) {
+                    char h = text[pos++];
+                    codepoint <<= 4;
+                    if (h >= '0' && h <= '9') codepoint |= h - '0';
+                    else if (h >= 'a' && h <= 'f') codepoint |= h - 'a' + 10;
+                    else if (h >= 'A' && h <= 'F') codepoint |= h - 'A' + 10;
+                }
+                appendUtf8(out, codepoint);
+            }
+            break;
+        default:
+            out.push_back(escaped);
+            break;
+        }
+    }
+    pos++; // Closing quote
+    return out;
+}
+
+// Java stores sign lines and names as JSON text components; Bedrock wants plain text
+std::string jsonTextToPlain(std::string_view json) {
+    size_t start = json.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+
+    if (json[start] == '"') {
+        return parseJsonString(json, start);
+    }
+
+    if (json[start] != '{' && json[start] != '[') {
+        return std::string(json);
+    }
+
+    // Concatenate every "text" value in document order (covers "extra" arrays)
+    std::string out;
+    size_t pos = 0;
+    while ((pos = json.find("\"text\"", pos)) != std::string_view::npos) {
+        pos += 6;
+        pos = json.find_first_not_of(" \t\r\n", pos);
+        if (pos == std::string_view::npos || json[pos] != ':') {
+            continue;
+        }
+        pos = json.find_first_not_of(" \t\r\n", pos + 1);
+        if (pos == std::string_view::npos || json[pos] != '"') {
+            continue;
+        }
+        out += parseJsonString(json, pos);
+    }
+    return out;
+}
+
+// Java DyeColor sign text colors as Bedrock ARGB
+int32_t signColorToArgb(std::string_view color) {
+    struct DyeColor {
+        std::string_view name;
+        uint32_t rgb;
+    };
+    static constexpr DyeColor colors[] = {
+        {"white", 0xFFFFFF},
+        {"orange", 0xFF681F},
+        {"magenta", 0xFF00FF},
+        {"light_blue", 0x9AC0CD},
+        {"yellow", 0xFFFF00},
+        {"lime", 0xBFFF00},
+        {"pink", 0xFF69B4},
+        {"gray", 0x808080},
+        {"light_gray", 0xD3D3D3},
+        {"cyan", 0x00FFFF},
+        {"purple", 0xA020F0},
+        {"blue", 0x0000FF},
+        {"brown", 0x8B4513},
+        {"green", 0x00FF00},
+        {"red", 0xFF0000},
+        {"black", 0x000000},
+    };
+    for (const auto& dye : colors) {
+        if (dye.name == color) {
+            return static_cast<int32_t>(0xFF000000u | dye.rgb);
+        }
+    }
+    return static_cast<int32_t>(0xFF000000u);
+}
+
+NbtNode makeSignText(const std::vector<std::string>& lines, std::string_view color, bool glowing) {
+    std::string text;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i > 0) {
+            text.push_back('\n');
+        }
+        text += lines[i];
+    }
+    // Drop trailing empty lines so the sign does not carry blank rows
+    while (!text.empty() && text.back() == '\n') {
+        text.pop_back();
+    }
+
+    NbtNode side = NbtNode::makeCompound();
+    side.set("Text", NbtNode::makeString(std::move(text)));
+    side.set("SignTextColor", NbtNode::makeInt(TagType::Int, signColorToArgb(color)));
+    side.set("IgnoreLighting", NbtNode::makeInt(TagType::Byte, glowing ? 1 : 0));
+    side.set("HideGlowOutline", NbtNode::makeInt(TagType::Byte, 0));
+    side.set("PersistFormatting", NbtNode::makeInt(TagType::Byte, 1));
+    side.set("TextOwner", NbtNode::makeString(""));
+    return side;
+}
+
+// 1.20+ front_text / back_text compound
+NbtNode convertSignSide(const NbtNode* side) {
+    std::vector<std::string> lines;
+    std::string color = "black";
+    bool glowing = false;
+    if (side && side->type == TagType::Compound) {
+        if (const NbtNode* messages = side->find("messages"); messages && messages->type == TagType::List) {
+            for (const auto& message : messages->list) {
+                lines.push_back(message.type == TagType::String ? jsonTextToPlain(message.stringValue) : std::string());
+            }
+        }
+        if (auto value = getString(*side, "color"); !value.empty()) {
+            color = value;
+        }
+        glowing = getInt(*side, "has_glowing_text", 0) != 0;
+    }
+    return makeSignText(lines, color, glowing);
+}
+
+// Signs and hanging signs share their text layout; only the block actor id differs
+void convertSign(const NbtNode& data, NbtNode& out, std::string_view bedrockId) {
+    out.set("id", NbtNode::makeString(std::string(bedrockId)));
+
+    if (data.find("front_text")) {
+        out.set("FrontText", convertSignSide(data.find("front_text")));
+        out.set("BackText", convertSignSide(data.find("back_text")));
+        out.set("IsWaxed", NbtNode::makeInt(TagType::Byte, getInt(data, "is_waxed", 0) != 0 ? 1 : 0));
+        return;
+    }
+
+    // Pre-1.20: Text1..Text4, Color, GlowingText
+    std::vector<std::string> lines;
+    for (const char* key : {"Text1", "Text2", "Text3", "Text4"}) {
+        lines.push_back(jsonTextToPlain(getString(data, key)));
+    }
+    std::string color = getString(data, "Color");
+    out.set("FrontText", makeSignText(lines, color.empty() ? "black" : color, getInt(data, "GlowingText", 0) != 0));
+    out.set("BackText", makeSignText({}, "black", false));
+}
+
+void convertContainer(const NbtNode& data, NbtNode& out) {
+    const NbtNode* items = data.find("Items");
+    if (!items || items->type != TagType::List) {
+        return;
+    }
+
+    NbtNode converted = NbtNode::makeList(TagType::Compound);
+    for (const auto& item : items->list) {
+        if (item.type != TagType::Compound) {
+            continue;
+        }
+        std::string id = getString(item, "id");
+        if (id.empty()) {
+            continue;
+        }
+        // "Count" (byte) before 1.20.5, "count" (int) after
+        int64_t count = getInt(item, "Count", getInt(item, "count", 1));
+
+        NbtNode entry = NbtNode::makeCompound();
+        entry.set("Slot", NbtNode::makeInt(TagType::Byte, getInt(item, "Slot", 0)));
+        entry.set("Name", NbtNode::makeString(std::move(id)));
+        entry.set("Count", NbtNode::makeInt(TagType::Byte, count));
+        entry.set("Damage", NbtNode::makeInt(TagType::Short, 0));
+        entry.set("WasPickedUp", NbtNode::makeInt(TagType::Byte, 0));
+        converted.list.push_back(std::move(entry));
+    }
+    out.set("Items", std::move(converted));
+}
+
+void convertSpawner(const NbtNode& data, NbtNode& out) {
+    out.set("id", NbtNode::makeString("MobSpawner"));
+
+    // 1.18+: SpawnData.entity.id, older: SpawnData.id
+    std::string entityId;
+    if (const NbtNode* spawnData = data.find("SpawnData"); spawnData && spawnData->type == TagType::Compound) {
+        const NbtNode* entity = spawnData->find("entity");
+        entityId = getString(entity && entity->type == TagType::Compound ? *entity : *spawnData, "id");
+    }
+    if (!entityId.empty()) {
+        out.set("EntityIdentifier", NbtNode::makeString(std::move(entityId)));
+    }
+
+    // Timing fields share their names with Bedrock
+    for (const char* key :
+         {"Delay", "MinSpawnDelay", "MaxSpawnDelay", "SpawnCount", "MaxNearbyEntities", "RequiredPlayerRange",
+          "SpawnRange"}) {
+        if (const NbtNode* value = data.find(key); value && value->type == TagType::Short) {
+            out.set(key, *value);
+        }
+    }
+}
+
+bool isContainer(std::string_view id, std::string_view& bedrockId) {
+    struct Container {
+        std::string_view java;
+        std::string_view bedrock;
+    };
+    static constexpr Container containers[] = {
+        {"chest", "Chest"},
+        {"trapped_chest", "Chest"},
+        {"barrel", "Barrel"},
+        {"hopper", "Hopper"},
+        {"dispenser", "Dispenser"},
+        {"dropper", "Dropper"},
+        {"furnace", "Furnace"},
+        {"blast_furnace", "BlastFurnace"},
+        {"smoker", "Smoker"},
+    };
+    for (const auto& container : containers) {
+        if (container.java == id) {
+            bedrockId = container.bedrock;
+            return true;
+        }
+    }
+    if (id == "shulker_box" || (id.size() > 12 && id.substr(id.size() - 12) == "_shulker_box")) {
+        bedrockId = "ShulkerBox";
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void BlockEntityStore::buildIndex() const {
+    for (uint32_t s = 0; s < mSegments.size(); s++) {
+        const auto& segment = mSegments[s];
+        const uint8_t* data = segment.bytes.data();
+        size_t size = segment.bytes.size();
+        size_t pos = 0;
+
+        for (int32_t i = 0; i < segment.count && pos < size; i++) {
+            size_t entryStart = pos;
+            int x = 0, y = 0, z = 0;
+            bool hasPos = false;
+            bool truncated = false;
+
+            // Scan only the top-level fields, nested payloads are skipped by length
+            while (true) {
+                if (pos >= size) {
+                    truncated = true;
+                    break;
+                }
+                auto type = static_cast<TagType>(data[pos++]);
+                if (type == TagType::End) {
+                    break;
+                }
+                if (pos + 2 > size) {
+                    truncated = true;
+                    break;
+                }
+                size_t nameLength = (static_cast<size_t>(data[pos]) << 8) | data[pos + 1];
+                pos += 2;
+                if (pos + nameLength > size) {
+                    truncated = true;
+                    break;
+                }
+                std::string_view name(reinterpret_cast<const char*>(data + pos), nameLength);
+                pos += nameLength;
+
+                if (type == TagType::IntArray && name == "Pos" && pos + 16 <= size && readInt32(data + pos) >= 3) {
+                    x = readInt32(data + pos + 4);
+                    y = readInt32(data + pos + 8);
+                    z = readInt32(data + pos + 12);
+                    hasPos = true;
+                } else if (segment.format == BlockEntityFormat::Litematica && type == TagType::Int
+                           && name.size() == 1 && pos + 4 <= size) {
+                    int value = readInt32(data + pos);
+                    if (name == "x") x = value;
+                    else if (name == "y") y = value;
+                    else if (name == "z") z = value;
+                    hasPos = true;
+                }
+                try {
+                    skipNbtPayload(data, size, pos, type);
+                } catch (const std::exception&) {
+                    truncated = true;
+                    break;
+                }
+            }
+            if (truncated) {
+                break; // The rest of this segment is unreadable; later segments still count
+            }
+
+            x += segment.originX;
+            y += segment.originY;
+            z += segment.originZ;
+            if (!hasPos || x < 0 || y < 0 || z < 0 || x > kMaxCoordinate || y > kMaxCoordinate
+                || z > kMaxCoordinate) {
+                continue;
+            }
+            mIndex[packPosition(x, y, z)] = {s, static_cast<uint32_t>(entryStart)};
+        }
+    }
+    mIndexBuilt.store(true, std::memory_order_release);
+}
+
+size_t BlockEntityStore::getMemoryUsage() const {
+    size_t total = mSegments.capacity() * sizeof(BlockEntitySegment);
+    for (const auto& segment : mSegments) {
+        total += segment.bytes.capacity();
+    }
+    if (mIndexBuilt.load(std::memory_order_acquire)) {
+        // Node: key/value pair, next pointer and cached hash; plus the bucket array
+        total += mIndex.size() * (sizeof(std::pair<const uint64_t, EntryRef>) + 2 * sizeof(void*));
+        total += mIndex.bucket_count() * sizeof(void*);
+    }
+    return total;
+}
+
+size_t BlockEntityStore::getEntryCount() const {
+    std::call_once(mIndexOnce, [this] { buildIndex(); });
+    return mIndex.size();
+}
+
+std::vector<uint64_t> BlockEntityStore::getPositions() const {
+    std::call_once(mIndexOnce, [this] { buildIndex(); });
+
+    std::vector<uint64_t> positions;
+    positions.reserve(mIndex.size());
+    for (const auto& [key, ref] : mIndex) {
+        positions.push_back(key);
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+std::optional<BlockEntityData> BlockEntityStore::find(int x, int y, int z) const {
+    std::call_once(mIndexOnce, [this] { buildIndex(); });
+
+    if (x < 0 || y < 0 || z < 0) {
+        return std::nullopt;
+    }
+    auto it = mIndex.find(packPosition(x, y, z));
+    if (it == mIndex.end()) {
+        return std::nullopt;
+    }
+
+    const auto& segment = mSegments[it->second.segment];
+    size_t pos = it->second.offset;
+    NbtNode entry = readNbtPayload(segment.bytes.data(), segment.bytes.size(), pos, TagType::Compound);
+
+    BlockEntityData result;
+    result.x = x;
+    result.y = y;
+    result.z = z;
+    result.id = getString(entry, "Id");
+    if (result.id.empty()) {
+        result.id = getString(entry, "id");
+    }
+
+    if (segment.format == BlockEntityFormat::SpongeV3) {
+        if (const NbtNode* data = entry.find("Data"); data && data->type == TagType::Compound) {
+            result.data = *data;
+        } else {
+            result.data = NbtNode::makeCompound();
+        }
+    } else {
+        result.data = std::move(entry);
+    }
+    return result;
+}
+
+std::string convertBlockEntityToBedrock(const BlockEntityData& entity, int worldX, int worldY, int worldZ) {
+    std::string_view id = stripNamespace(entity.id);
+
+    // Position first, at fixed offsets, so setBedrockBlockEntityPosition can patch it in place
+    NbtNode out = NbtNode::makeCompound();
+    out.set("x", NbtNode::makeInt(TagType::Int, worldX));
+    out.set("y", NbtNode::makeInt(TagType::Int, worldY));
+    out.set("z", NbtNode::makeInt(TagType::Int, worldZ));
+    out.set("isMovable", NbtNode::makeInt(TagType::Byte, 1));
+
+    std::string_view containerId;
+    if (isContainer(id, containerId)) {
+        out.set("id", NbtNode::makeString(std::string(containerId)));
+        convertContainer(entity.data, out);
+    } else if (id == "hanging_sign" || id.ends_with("_hanging_sign")) {
+        convertSign(entity.data, out, "HangingSign");
+    } else if (id == "sign" || id.ends_with("_sign")) {
+        convertSign(entity.data, out, "Sign");
+    } else if (id == "spawner" || id == "mob_spawner") {
+        convertSpawner(entity.data, out);
+    } else {
+        return {};
+    }
+
+    if (auto customName = getString(entity.data, "CustomName"); !customName.empty()) {
+        out.set("CustomName", NbtNode::makeString(jsonTextToPlain(customName)));
+    }
+
+    return writeBedrockNbt(out);
+}
+
+bool setBedrockBlockEntityPosition(std::string& nbt, int worldX, int worldY, int worldZ) {
+    // Root compound tag and its empty name, then one Int entry per axis: type, name length, name, value
+    constexpr size_t kFirstEntry = 3;
+    constexpr size_t kEntrySize = 1 + 2 + 1 + 4;
+    const char names[3] = {'x', 'y', 'z'};
+    const int values[3] = {worldX, worldY, worldZ};
+
+    if (nbt.size() < kFirstEntry + 3 * kEntrySize) {
+        return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        size_t entry = kFirstEntry + axis * kEntrySize;
+        if (static_cast<TagType>(nbt[entry]) != TagType::Int || nbt[entry + 1] != 1 || nbt[entry + 2] != 0
+            || nbt[entry + 3] != names[axis]) {
+            return false;
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        auto value = static_cast<uint32_t>(values[axis]);
+        for (int i = 0; i < 4; i++) {
+            nbt[kFirstEntry + axis * kEntrySize + 4 + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+    return true;
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "mod/Nbt.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wooden_axe {
+
+// Layout of the entries inside a block-entity list
+enum class BlockEntityFormat : uint8_t {
+    SpongeV2,  // { Pos: int[3], Id, ...fields }
+    SpongeV3,  // { Pos: int[3], Id, Data: { ...fields } }
+    Litematica // { x, y, z, id, ...fields }
+};
+
+// Raw bytes of one block-entity list, copied out of the file at load time
+struct BlockEntitySegment {
+    BlockEntityFormat format = BlockEntityFormat::SpongeV2;
+    std::vector<uint8_t> bytes; // List payload after the element type and count
+    int32_t count = 0;
+    int originX = 0, originY = 0, originZ = 0; // Added to entry positions (Litematica regions)
+};
+
+// One block entity parsed on demand, position in schematic-local coordinates
+struct BlockEntityData {
+    int x = 0, y = 0, z = 0;
+    std::string id; // Java id, e.g. "minecraft:chest"
+    NbtNode data;   // Java fields (Sponge v3 "Data" unwrapped)
+};
+
+// Block entities of a loaded schematic.
+// Loading only copies the list bytes; the position index is built on first use
+// and entries are decoded one at a time when a paste needs them.
+class BlockEntityStore {
+public:
+    void addSegment(BlockEntitySegment segment) { mSegments.push_back(std::move(segment)); }
+
+    bool empty() const { return mSegments.empty(); }
+
+    size_t getRawSize() const {
+        size_t total = 0;
+        for (const auto& segment : mSegments) {
+            total += segment.bytes.size();
+        }
+        return total;
+    }
+
+    // Heap bytes held: raw segments plus the index once it is built
+    size_t getMemoryUsage() const;
+
+    const std::vector<BlockEntitySegment>& getSegments() const { return mSegments; }
+
+    // Number of indexed entries (builds the index)
+    size_t getEntryCount() const;
+
+    // Packed positions of every entry, sorted by Y, then Z, then X (builds the index)
+    std::vector<uint64_t> getPositions() const;
+
+    // Decode the entry at a schematic-local position
+    std::optional<BlockEntityData> find(int x, int y, int z) const;
+
+    static uint64_t packPosition(int x, int y, int z) {
+        return (static_cast<uint64_t>(y) << 42) | (static_cast<uint64_t>(z) << 21) | static_cast<uint64_t>(x);
+    }
+
+    static void unpackPosition(uint64_t key, int& x, int& y, int& z) {
+        x = static_cast<int>(key & 0x1FFFFF);
+        z = static_cast<int>((key >> 21) & 0x1FFFFF);
+        y = static_cast<int>(key >> 42);
+    }
+
+private:
+    struct EntryRef {
+        uint32_t segment;
+        uint32_t offset;
+    };
+
+    void buildIndex() const;
+
+    std::vector<BlockEntitySegment> mSegments;
+    mutable std::once_flag mIndexOnce;
+    mutable std::unordered_map<uint64_t, EntryRef> mIndex;
+    mutable std::atomic<bool> mIndexBuilt{false};
+};
+
+// Convert a Java block entity into a Bedrock block-actor tag (little-endian NBT)
+// at the given world position. Returns an empty string for unsupported types.
+std::string convertBlockEntityToBedrock(const BlockEntityData& entity, int worldX, int worldY, int worldZ);
+
+// Rewrite the position stored in a tag made by convertBlockEntityToBedrock, for a copy placed
+// elsewhere. Block actors take their position from these tags when loaded. False if the tag
+// does not have that layout.
+bool setBedrockBlockEntityPosition(std::string& nbt, int worldX, int worldY, int worldZ);
+
+} // namespace wooden_axe
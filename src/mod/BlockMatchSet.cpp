@@ -0,0 +1,48 @@
+#include "mod/BlockMatchSet.h"
+#include "mod/SelectionOperations.h"
+
+#include "mc/world/level/block/Block.h"
+
+namespace wooden_axe {
+
+bool BlockMatchSet::parse(const std::string& names, std::string& unknown) {
+    mTypes.clear();
+    mTypeNames.clear();
+
+    size_t start = 0;
+    while (start <= names.size()) {
+        size_t comma = names.find(',', start);
+        if (comma == std::string::npos) {
+            comma = names.size();
+        }
+
+        std::string name = names.substr(start, comma - start);
+        if (!name.empty()) {
+            const Block* block = resolveBlockName(name);
+            if (!block) {
+                unknown = name;
+                return false;
+            }
+            const BlockLegacy* type = &block->getLegacyBlock();
+            if (std::find(mTypes.begin(), mTypes.end(), type) == mTypes.end()) {
+                mTypes.push_back(type);
+                mTypeNames.push_back(block->getTypeName());
+            }
+        }
+        start = comma + 1;
+    }
+    return !mTypes.empty();
+}
+
+bool BlockMatchSet::contains(const Block& block) const {
+    const BlockLegacy* type = &block.getLegacyBlock();
+    // Typically one or two entries, a linear scan beats hashing
+    for (const BlockLegacy* candidate : mTypes) {
+        if (candidate == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace wooden_axe
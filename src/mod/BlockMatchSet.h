@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+class Block;
+class BlockLegacy;
+
+namespace wooden_axe {
+
+// Block types a replace or paste mask matches, so every state of a type matches.
+// Server blocks are compared by BlockLegacy identity; blocks only a WorldSink can look into are
+// compared by the type name it reports.
+class BlockMatchSet {
+public:
+    // Comma-separated names; returns false and fills `unknown` on the first unresolved name
+    bool parse(const std::string& names, std::string& unknown);
+
+    bool empty() const { return mTypes.empty(); }
+    bool contains(const Block& block) const;
+
+    // Type name without states ("minecraft:stone"), as WorldSink::getBlockTypeName reports it
+    bool containsType(const std::string& typeName) const {
+        return std::find(mTypeNames.begin(), mTypeNames.end(), typeName) != mTypeNames.end();
+    }
+
+private:
+    std::vector<const BlockLegacy*> mTypes;
+    std::vector<std::string> mTypeNames; // Same order as mTypes
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,108 @@
+#include "mod/BudgetController.h"
+
+#include <algorithm>
+
+namespace wooden_axe {
+
+namespace {
+
+// Weight of the newest sample in the per-block cost average
+constexpr double kCostSmoothing = 0.25;
+
+// Budget may at most double per tick, so a cheap run of air does not cause a spike
+constexpr double kMaxGrowth = 2.0;
+
+// Fraction of maxSliceMs regained per tick once the server is back under target
+constexpr double kRecoveryStep = 0.1;
+
+// Slices this small say little about per-block cost (timer resolution)
+constexpr size_t kMinSampleBlocks = 64;
+
+double toMs(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+BudgetController::BudgetController(BudgetSettings settings, Clock clock)
+: mSettings(settings),
+  mClock(std::move(clock)),
+  mBudget(std::clamp(settings.initialBlocks, settings.minBlocks, settings.maxBlocks)),
+  mAllowedSliceMs(settings.maxSliceMs) {}
+
+void BudgetController::setSettings(const BudgetSettings& settings) {
+    mSettings = settings;
+    mBudget = std::clamp(mBudget, settings.minBlocks, settings.maxBlocks);
+    mAllowedSliceMs = std::min(mAllowedSliceMs, settings.maxSliceMs);
+}
+
+void BudgetController::reset() {
+    mHasTickStart = false;
+    mInSlice = false;
+    mBudget = std::clamp(mSettings.initialBlocks, mSettings.minBlocks, mSettings.maxBlocks);
+    mAllowedSliceMs = mSettings.maxSliceMs;
+    mNsPerBlock = 0.0;
+    mLastSliceMs = 0.0;
+    mLastTickMs = 0.0;
+    mPendingSliceMs = 0.0;
+    mPendingBlocks = 0;
+}
+
+size_t BudgetController::beginSlice() {
+    auto now = mClock();
+
+    // Start-to-start interval covers the whole previous tick, our slice included
+    if (mHasTickStart) {
+        update(toMs(now - mTickStart), mPendingSliceMs, mPendingBlocks);
+    }
+    mTickStart = now;
+    mHasTickStart = true;
+    mPendingSliceMs = 0.0;
+    mPendingBlocks = 0;
+
+    mSliceStart = now;
+    mInSlice = true;
+    return mBudget;
+}
+
+void BudgetController::endSlice(size_t blocksUsed) {
+    if (!mInSlice) {
+        return;
+    }
+    mInSlice = false;
+    mPendingSliceMs = toMs(mClock() - mSliceStart);
+    mPendingBlocks = blocksUsed;
+}
+
+void BudgetController::update(double tickMs, double sliceMs, size_t blocksUsed) {
+    mLastTickMs = tickMs;
+    mLastSliceMs = sliceMs;
+
+    // Idle ticks carry no information about cost or load
+    if (blocksUsed == 0) {
+        return;
+    }
+
+    if (blocksUsed >= kMinSampleBlocks && sliceMs > 0.0) {
+        double sample = sliceMs * 1e6 / static_cast<double>(blocksUsed);
+        mNsPerBlock = mNsPerBlock > 0.0 ? mNsPerBlock + kCostSmoothing * (sample - mNsPerBlock) : sample;
+    }
+
+    // Over target: give back the overrun at once. Under target: creep back toward the cap.
+    // A server that keeps up ticks every targetMspt exactly, so the interval cannot show spare time.
+    if (tickMs > mSettings.targetMspt) {
+        mAllowedSliceMs = std::max(0.0, std::min(mAllowedSliceMs, sliceMs) - (tickMs - mSettings.targetMspt));
+    } else {
+        mAllowedSliceMs = std::min(mSettings.maxSliceMs, mAllowedSliceMs + mSettings.maxSliceMs * kRecoveryStep);
+    }
+
+    if (mNsPerBlock <= 0.0) {
+        return; // Keep the initial budget until there is a usable sample
+    }
+
+    double target = mAllowedSliceMs * 1e6 / mNsPerBlock;
+    target = std::min(target, static_cast<double>(mBudget) * kMaxGrowth);
+    mBudget = std::clamp(static_cast<size_t>(target), mSettings.minBlocks, mSettings.maxBlocks);
+}
+
+} // namespace wooden_axe
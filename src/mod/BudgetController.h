@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace wooden_axe {
+
+struct BudgetSettings {
+    double targetMspt = 50.0;   // Server tick length we try not to exceed
+    double maxSliceMs = 10.0;   // Upper bound on time spent writing blocks per tick
+    size_t initialBlocks = 20000;
+    size_t minBlocks = 256;
+    size_t maxBlocks = 200000;
+};
+
+// Feedback controller for the per-tick block budget.
+// Each tick it sees how long the previous placement slice took and how long the
+// whole server tick took, and sizes the next slice to fit the remaining headroom.
+// Has no engine dependencies; time comes from an injectable clock so it can be
+// driven by a simulated one.
+class BudgetController {
+public:
+    using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+    explicit BudgetController(BudgetSettings settings = {}, Clock clock = &std::chrono::steady_clock::now);
+
+    // Call at the start of each tick's slice, returns the block budget to use
+    size_t beginSlice();
+
+    // Call after the slice with the number of block operations performed
+    void endSlice(size_t blocksUsed);
+
+    void reset();
+
+    void setSettings(const BudgetSettings& settings);
+
+    size_t getBudget() const { return mBudget; }
+    double getSliceMs() const { return mLastSliceMs; }
+    double getTickMs() const { return mLastTickMs; }
+    double getNsPerBlock() const { return mNsPerBlock; }
+
+    // Feed one measurement directly (what beginSlice/endSlice do with the clock)
+    void update(double tickMs, double sliceMs, size_t blocksUsed);
+
+private:
+    BudgetSettings mSettings;
+    Clock mClock;
+
+    std::chrono::steady_clock::time_point mTickStart{};
+    std::chrono::steady_clock::time_point mSliceStart{};
+    bool mHasTickStart = false;
+    bool mInSlice = false;
+
+    size_t mBudget;
+    double mAllowedSliceMs;
+    double mNsPerBlock = 0.0; // Smoothed cost of one block write, 0 until measured
+    double mLastSliceMs = 0.0;
+    double mLastTickMs = 0.0;
+    double mPendingSliceMs = 0.0;
+    size_t mPendingBlocks = 0;
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,45 @@
+#include "mod/ChunkPreloader.h"
+#include "mod/WorldSink.h"
+
+namespace wooden_axe {
+
+bool ChunkPreloader::request(int chunkX, int chunkZ) {
+    auto key = makeKey(chunkX, chunkZ);
+    if (mRequested.contains(key)) {
+        return true;
+    }
+    if (!mSink.requestChunk(chunkX, chunkZ)) {
+        return false;
+    }
+    mRequested.emplace(key, std::chrono::steady_clock::now());
+    return true;
+}
+
+ChunkLoadState ChunkPreloader::poll(int chunkX, int chunkZ) const {
+    auto it = mRequested.find(makeKey(chunkX, chunkZ));
+    if (it == mRequested.end()) {
+        return ChunkLoadState::Loading;
+    }
+    if (mSink.isChunkReady(chunkX, chunkZ)) {
+        return ChunkLoadState::Ready;
+    }
+    if (std::chrono::steady_clock::now() - it->second > mTimeout) {
+        return ChunkLoadState::TimedOut;
+    }
+    return ChunkLoadState::Loading;
+}
+
+void ChunkPreloader::release(int chunkX, int chunkZ) {
+    if (mRequested.erase(makeKey(chunkX, chunkZ)) > 0) {
+        mSink.releaseChunk(chunkX, chunkZ);
+    }
+}
+
+void ChunkPreloader::clear() {
+    for (const auto& [key, requested] : mRequested) {
+        mSink.releaseChunk(static_cast<int>(key >> 32), static_cast<int>(static_cast<uint32_t>(key)));
+    }
+    mRequested.clear();
+}
+
+} // namespace wooden_axe
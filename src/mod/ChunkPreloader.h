@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace wooden_axe {
+
+class WorldSink;
+
+enum class ChunkLoadState : uint8_t {
+    Loading,
+    Ready,
+    TimedOut
+};
+
+// Deferred chunk loads for one paste target (server thread).
+// Requested chunks are held by the sink until released, so the pipeline can load
+// ahead of the writer without the engine unloading them in between.
+class ChunkPreloader {
+public:
+    // A chunk still not loaded `timeout` after its request polls as TimedOut
+    ChunkPreloader(WorldSink& sink, std::chrono::seconds timeout) : mSink(sink), mTimeout(timeout) {}
+
+    // Ask for a chunk without blocking; false if the world is unavailable
+    bool request(int chunkX, int chunkZ);
+
+    ChunkLoadState poll(int chunkX, int chunkZ) const;
+
+    void release(int chunkX, int chunkZ);
+
+    void clear();
+
+    size_t getInFlight() const { return mRequested.size(); }
+
+private:
+    static uint64_t makeKey(int chunkX, int chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkZ);
+    }
+
+    WorldSink& mSink;
+    std::chrono::seconds mTimeout;
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> mRequested;
+};
+
+} // namespace wooden_axe
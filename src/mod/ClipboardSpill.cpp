@@ -0,0 +1,267 @@
+#include "mod/ClipboardSpill.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace wooden_axe {
+
+namespace {
+
+constexpr char kMagic[4] = {'W', 'A', 'C', 'B'};
+constexpr uint32_t kVersion = 3;
+
+class Writer {
+public:
+    void u8(uint8_t value) { mData.push_back(value); }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            mData.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            mData.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void i32(int32_t value) { u32(static_cast<uint32_t>(value)); }
+
+    void string(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        mData.insert(mData.end(), value.begin(), value.end());
+    }
+
+    void bytes(const std::vector<uint8_t>& value) {
+        u64(value.size());
+        mData.insert(mData.end(), value.begin(), value.end());
+    }
+
+    std::vector<uint8_t>& data() { return mData; }
+
+private:
+    std::vector<uint8_t> mData;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
+
+    uint8_t u8() {
+        require(1);
+        return mData[mPos++];
+    }
+
+    uint32_t u32() {
+        require(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<uint32_t>(mData[mPos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t u64() {
+        require(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= static_cast<uint64_t>(mData[mPos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+
+    std::string string() {
+        uint32_t length = u32();
+        require(length);
+        std::string value(reinterpret_cast<const char*>(mData + mPos), length);
+        mPos += length;
+        return value;
+    }
+
+    std::vector<uint8_t> bytes() {
+        uint64_t length = u64();
+        require(length);
+        std::vector<uint8_t> value(mData + mPos, mData + mPos + length);
+        mPos += length;
+        return value;
+    }
+
+private:
+    void require(uint64_t count) {
+        if (count > mSize - mPos) {
+            throw std::runtime_error("Spill: Unexpected end of data");
+        }
+    }
+
+    const uint8_t* mData;
+    size_t mSize;
+    size_t mPos = 0;
+};
+
+} // namespace
+
+bool writeClipboardSpill(const Schematic& schem, const std::filesystem::path& path) {
+    Writer writer;
+    writer.i32(schem.width);
+    writer.i32(schem.height);
+    writer.i32(schem.length);
+    writer.i32(schem.offsetX);
+    writer.i32(schem.offsetY);
+    writer.i32(schem.offsetZ);
+
+    writer.u32(static_cast<uint32_t>(schem.palette.size()));
+    for (const auto& block : schem.palette) {
+        writer.string(block.name);
+        writer.u32(static_cast<uint32_t>(block.properties.size()));
+        for (const auto& [key, value] : block.properties) {
+            writer.string(key);
+            writer.string(value);
+        }
+    }
+
+    // Sections as held in memory, shared contents included
+    const auto& sections = schem.blocks.getSections();
+    writer.u64(sections.size());
+    for (const auto& section : sections) {
+        writer.u8(static_cast<uint8_t>(section.kind));
+        writer.u8(section.width);
+        writer.i32(section.value);
+        writer.u32(section.size);
+        writer.u64(section.offset);
+    }
+    writer.bytes(schem.blocks.getData());
+
+    const auto* segments = schem.blockEntities ? &schem.blockEntities->getSegments() : nullptr;
+    writer.u32(segments ? static_cast<uint32_t>(segments->size()) : 0);
+    if (segments) {
+        for (const auto& segment : *segments) {
+            writer.u8(static_cast<uint8_t>(segment.format));
+            writer.i32(segment.count);
+            writer.i32(segment.originX);
+            writer.i32(segment.originY);
+            writer.i32(segment.originZ);
+            writer.bytes(segment.bytes);
+        }
+    }
+
+    auto& raw = writer.data();
+    if (raw.size() > std::numeric_limits<uLong>::max()) {
+        return false;
+    }
+
+    uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> compressed(compressedSize);
+    if (compress2(compressed.data(), &compressedSize, raw.data(), static_cast<uLong>(raw.size()), Z_BEST_SPEED)
+        != Z_OK) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    Writer header;
+    header.u32(kVersion);
+    header.u64(raw.size());
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(header.data().data()), static_cast<std::streamsize>(header.data().size()));
+    file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressedSize));
+    return static_cast<bool>(file);
+}
+
+std::optional<Schematic> readClipboardSpill(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    try {
+        constexpr size_t kHeaderSize = sizeof(kMagic) + 4 + 8;
+        if (contents.size() < kHeaderSize || std::memcmp(contents.data(), kMagic, sizeof(kMagic)) != 0) {
+            return std::nullopt;
+        }
+
+        Reader header(contents.data() + sizeof(kMagic), 12);
+        if (header.u32() != kVersion) {
+            return std::nullopt;
+        }
+        uint64_t rawSize = header.u64();
+        if (rawSize > std::numeric_limits<uLong>::max()) {
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> raw(rawSize);
+        uLongf destSize = static_cast<uLongf>(rawSize);
+        if (uncompress(raw.data(), &destSize, contents.data() + kHeaderSize,
+                       static_cast<uLong>(contents.size() - kHeaderSize))
+                != Z_OK
+            || destSize != rawSize) {
+            return std::nullopt;
+        }
+
+        Reader reader(raw.data(), raw.size());
+        Schematic schem;
+        schem.width = reader.i32();
+        schem.height = reader.i32();
+        schem.length = reader.i32();
+        schem.offsetX = reader.i32();
+        schem.offsetY = reader.i32();
+        schem.offsetZ = reader.i32();
+
+        schem.palette.resize(reader.u32());
+        for (auto& block : schem.palette) {
+            block.name = reader.string();
+            uint32_t propertyCount = reader.u32();
+            for (uint32_t i = 0; i < propertyCount; i++) {
+                auto key = reader.string();
+                block.properties.emplace(std::move(key), reader.string());
+            }
+        }
+
+        uint64_t sectionCount = reader.u64();
+        if (sectionCount > raw.size()) {
+            return std::nullopt; // Every section takes several bytes
+        }
+        std::vector<SectionedBlocks::Section> sections(sectionCount);
+        for (auto& section : sections) {
+            section.kind = static_cast<SectionedBlocks::Kind>(reader.u8());
+            section.width = reader.u8();
+            section.value = reader.i32();
+            section.size = reader.u32();
+            section.offset = reader.u64();
+        }
+        schem.blocks = SectionedBlocks::fromSections(
+            schem.width, schem.height, schem.length, std::move(sections), reader.bytes()
+        );
+        schem.occupancy = computeOccupancy(schem);
+
+        uint32_t segmentCount = reader.u32();
+        if (segmentCount > 0) {
+            auto store = std::make_shared<BlockEntityStore>();
+            for (uint32_t i = 0; i < segmentCount; i++) {
+                BlockEntitySegment segment;
+                segment.format = static_cast<BlockEntityFormat>(reader.u8());
+                segment.count = reader.i32();
+                segment.originX = reader.i32();
+                segment.originY = reader.i32();
+                segment.originZ = reader.i32();
+                segment.bytes = reader.bytes();
+                store->addSegment(std::move(segment));
+            }
+            schem.blockEntities = std::move(store);
+        }
+        return schem;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace wooden_axe
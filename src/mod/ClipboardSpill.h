@@ -0,0 +1,17 @@
+#pragma once
+
+#include "mod/SchematicReader.h"
+
+#include <filesystem>
+#include <optional>
+
+namespace wooden_axe {
+
+// Compact on-disk copy of an evicted clipboard: palette, varint block indices and
+// raw block-entity segments, deflated at the fastest level. Private to this plugin,
+// only ever read back by the process that wrote it.
+bool writeClipboardSpill(const Schematic& schem, const std::filesystem::path& path);
+
+std::optional<Schematic> readClipboardSpill(const std::filesystem::path& path);
+
+} // namespace wooden_axe
@@ -1,17 +1,27 @@
 #include "mod/Commands.h"
 #include "mod/WoodenAxeMod.h"
 #include "mod/SchematicReader.h"
+#include "mod/SchematicCache.h"
 #include "mod/SchematicPlacer.h"
+#include "mod/SelectionOperations.h"
+#include "mod/SessionStore.h"
+#include "mod/JobScheduler.h"
+#include "mod/Trace.h"
+#include "mod/WorkerPool.h"
 
 #include "ll/api/command/CommandHandle.h"
 #include "ll/api/command/CommandRegistrar.h"
 #include "ll/api/service/Bedrock.h"
+#include "ll/api/thread/ServerThreadExecutor.h"
 
 #include "mc/world/actor/player/Player.h"
+#include "mc/world/level/Level.h"
 #include "mc/server/commands/CommandOrigin.h"
 #include "mc/server/commands/CommandOutput.h"
 #include "mc/server/commands/CommandPermissionLevel.h"
 
+#include <chrono>
+#include <cstdio>
 #include <string>
 #include <filesystem>
 
@@ -20,16 +30,325 @@ namespace wooden_axe {
 // Command parameter structures
 struct WaListParams {};
 
+// memory: decode every block up front; stream: keep the header, read blocks while pasting
+enum class WaLoadMode { memory, stream };
+
 struct WaLoadParams {
     std::string filename;
+    WaLoadMode mode = WaLoadMode::memory;
+};
+
+// Lowercase so the command enum reads naturally in chat
+enum class WaPriority { low, normal, high };
+
+struct WaPasteParams {
+    WaPriority priority = WaPriority::normal;
+};
+
+// air: only into air; keep: never overwrite the listed world blocks; only: write only the listed schematic blocks
+enum class WaPasteAirMask { air };
+
+struct WaPasteAirParams {
+    WaPasteAirMask mask;
+    WaPriority priority = WaPriority::normal;
+};
+
+enum class WaPasteFilter { keep, only };
+
+struct WaPasteFilterParams {
+    WaPasteFilter filter;
+    std::string blocks;
+    WaPriority priority = WaPriority::normal;
 };
 
-struct WaPasteParams {};
+// Only the part of the schematic inside the pos1/pos2 box
+enum class WaPasteClip { clip };
+
+struct WaPasteClipParams {
+    WaPasteClip clip;
+    WaPriority priority = WaPriority::normal;
+};
+
+enum class WaPasteMode { dryrun };
+
+struct WaPasteDryRunParams {
+    WaPasteMode mode;
+};
+
+// Copies along X and Z; spacing is the gap left between neighbouring copies
+struct WaStampParams {
+    int countX;
+    int countZ;
+    int spacing;
+};
 
 struct WaPosParams {};
 
 struct WaClearParams {};
 
+struct WaSetParams {
+    std::string block;
+};
+
+struct WaReplaceParams {
+    std::string from;
+    std::string to;
+};
+
+struct WaJobsParams {};
+
+struct WaStatsParams {};
+
+enum class WaTraceMode { on, off };
+
+struct WaTraceParams {
+    WaTraceMode mode;
+};
+
+struct WaJobIdParams {
+    int id;
+};
+
+static std::string formatBytes(size_t bytes) {
+    char buffer[32];
+    if (bytes >= 1024 * 1024) {
+        std::snprintf(buffer, sizeof(buffer), "%.1f MB", static_cast<double>(bytes) / (1024 * 1024));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.1f KB", static_cast<double>(bytes) / 1024);
+    }
+    return buffer;
+}
+
+// Real extent of a schematic's blocks, e.g. "1200 blocks in 12x5x9 at (1, 0, 2), 80 columns"
+static std::string formatContent(const SchematicOccupancy& occupancy) {
+    return "§f" + std::to_string(occupancy.blocks) + " §7blocks in §f" + std::to_string(occupancy.getSizeX()) + "x"
+         + std::to_string(occupancy.getSizeY()) + "x" + std::to_string(occupancy.getSizeZ()) + " §7at ("
+         + std::to_string(occupancy.minX) + ", " + std::to_string(occupancy.minY) + ", "
+         + std::to_string(occupancy.minZ) + "), §f" + std::to_string(occupancy.footprint) + " §7columns";
+}
+
+static JobPriority toJobPriority(WaPriority priority) {
+    switch (priority) {
+    case WaPriority::low:
+        return JobPriority::Low;
+    case WaPriority::high:
+        return JobPriority::High;
+    default:
+        return JobPriority::Normal;
+    }
+}
+
+static const char* getStateName(JobState state) {
+    switch (state) {
+    case JobState::Queued:
+        return "queued";
+    case JobState::Running:
+        return "running";
+    case JobState::Paused:
+        return "paused";
+    case JobState::Finished:
+        return "finished";
+    default:
+        return "cancelled";
+    }
+}
+
+static const char* getPriorityName(JobPriority priority) {
+    switch (priority) {
+    case JobPriority::Low:
+        return "low";
+    case JobPriority::High:
+        return "high";
+    default:
+        return "normal";
+    }
+}
+
+// Message a player after an async job, if they are still online
+static void notifyPlayer(const mce::UUID& playerUuid, const std::string& message) {
+    auto* level = ll::service::getLevel();
+    auto* target = level ? level->getPlayer(playerUuid) : nullptr;
+    if (target) {
+        target->sendMessage(message);
+    }
+}
+
+// Replies of a command that may finish after its handler returned: to the command output while
+// the handler runs, to the player's chat once it continues from a callback
+struct CommandReply {
+    CommandOutput* output; // nullptr once the handler has returned
+    mce::UUID playerUuid;
+
+    void success(const std::string& message) const {
+        if (output) {
+            output->success(message);
+        } else {
+            notifyPlayer(playerUuid, message);
+        }
+    }
+
+    void error(const std::string& message) const {
+        if (output) {
+            output->error(message);
+        } else {
+            notifyPlayer(playerUuid, "§c" + message);
+        }
+    }
+};
+
+// Run `use` with the player's clipboard. A spilled clipboard is read back off the tick first and
+// `use` continues from there; the player is told when there is nothing to use.
+static void withClipboard(CommandOutput& output, const mce::UUID& playerUuid,
+                          const std::shared_ptr<PlayerSession>& session,
+                          std::function<void(std::shared_ptr<const Schematic>, const CommandReply&)> use) {
+    if (auto schem = session->getClipboard()) {
+        use(std::move(schem), CommandReply{&output, playerUuid});
+        return;
+    }
+    auto usage = session->getClipboardUsage();
+    if (!usage.spilled) {
+        output.error(usage.dropped ? "Your schematic was unloaded to save memory. Use /waload <filename> again"
+                                   : "No schematic loaded. Use /waload <filename> first");
+        return;
+    }
+
+    output.success("§7Reading your schematic back from disk...");
+    SessionStore::getInstance().restoreClipboard(
+        session,
+        [playerUuid, use = std::move(use)](std::shared_ptr<const Schematic> schem) {
+            CommandReply reply{nullptr, playerUuid};
+            if (!schem) {
+                reply.error("Failed to read your schematic back from disk. Use /waload <filename> again");
+                return;
+            }
+            use(std::move(schem), reply);
+        }
+    );
+}
+
+// Queue a paste of the player's clipboard at pos1, optionally limited to the pos1/pos2 box
+static void queuePaste(CommandOrigin const& origin, CommandOutput& output, WaPriority priority, PasteMask mask,
+                       bool clipToSelection = false) {
+    // Get player
+    auto* entity = origin.getEntity();
+    if (!entity || !entity->isPlayer()) {
+        output.error("This command can only be used by players");
+        return;
+    }
+    
+    Player* player = static_cast<Player*>(entity);
+    auto session = SessionStore::getInstance().getOrCreate(*player);
+    
+    // Get selection
+    auto selection = session->getSelection();
+    if (!selection.pos1) {
+        output.error("Please set pos1 first (left-click with wooden axe)");
+        return;
+    }
+    auto box = selection.getBox();
+    if (clipToSelection && !box) {
+        output.error("Please set pos1 and pos2 first (left/right-click with wooden axe)");
+        return;
+    }
+    
+    PasteOptions options = makePasteOptions(WoodenAxeMod::getInstance().getConfig());
+    options.priority = toJobPriority(priority);
+    options.mask = std::move(mask);
+    if (clipToSelection) {
+        options.clip = box;
+    }
+    
+    // Paste (plan is built off-thread, the player is notified when the writes land)
+    mce::UUID playerUuid = player->getUuid();
+    withClipboard(
+        output, playerUuid, session,
+        [session, selection, options, playerUuid](std::shared_ptr<const Schematic> schem, const CommandReply& reply) {
+            auto& pos = *selection.pos1;
+            auto job = SchematicPlacer::getInstance().pasteAsync(
+                std::move(schem), pos.x, pos.y, pos.z, makeDimensionSink(selection.dimension), session->getName(),
+                options,
+                [playerUuid](const PlaceResult& result) {
+                    if (result.ok && result.placed > 0) {
+                        std::string message = "§aPasted " + std::to_string(result.placed) + " blocks";
+                        if (result.kept > 0) {
+                            message += " §7(" + std::to_string(result.kept) + " kept by the mask)";
+                        }
+                        if (result.suppressedUpdates > 0) {
+                            message += " §7(" + std::to_string(result.suppressedUpdates)
+                                     + " block updates batched into " + std::to_string(result.refreshedSubchunks)
+                                     + " subchunk updates)";
+                        }
+                        notifyPlayer(playerUuid, message);
+                    } else {
+                        notifyPlayer(playerUuid, "§cFailed to paste schematic");
+                    }
+                }
+            );
+            
+            session->addJob(job);
+            
+            reply.success("§7Pasting... (job #" + std::to_string(job->getId()) + ")");
+        }
+    );
+}
+
+// Queue a fill/replace over the player's pos1/pos2 box
+static void queueRegionFill(CommandOrigin const& origin, CommandOutput& output, const std::string& toName,
+                            const std::string& fromNames) {
+    auto* entity = origin.getEntity();
+    if (!entity || !entity->isPlayer()) {
+        output.error("This command can only be used by players");
+        return;
+    }
+    
+    Player* player = static_cast<Player*>(entity);
+    auto session = SessionStore::getInstance().getOrCreate(*player);
+    auto selection = session->getSelection();
+    auto box = selection.getBox();
+    if (!box) {
+        output.error("Please set pos1 and pos2 first (left/right-click with wooden axe)");
+        return;
+    }
+    
+    // Resolve everything once, before any block is touched
+    const Block* target = resolveBlockName(toName);
+    if (!target) {
+        output.error("Unknown block: " + toName);
+        return;
+    }
+    
+    BlockMatchSet match;
+    if (!fromNames.empty()) {
+        std::string unknown;
+        if (!match.parse(fromNames, unknown)) {
+            output.error("Unknown block: " + (unknown.empty() ? fromNames : unknown));
+            return;
+        }
+    }
+    
+    bool isReplace = !match.empty();
+    size_t volume = box->getVolume();
+    mce::UUID playerUuid = player->getUuid();
+    
+    auto job = std::make_shared<RegionFillJob>(
+        *box, selection.dimension, *target, std::move(match),
+        [playerUuid, isReplace](const RegionOperationResult& result) {
+            std::string message = isReplace
+                ? "§aReplaced " + std::to_string(result.changed) + " blocks"
+                : "§aSet " + std::to_string(result.changed) + " blocks";
+            if (result.failed > 0) {
+                message += " §c(" + std::to_string(result.failed) + " failed)";
+            }
+            notifyPlayer(playerUuid, message);
+        }
+    );
+    session->addJob(job);
+    uint64_t id = JobScheduler::getInstance().submit(job, session->getName());
+    
+    output.success("§7Queued job #" + std::to_string(id) + ": " + std::to_string(volume) + " blocks ("
+                   + std::to_string(JobScheduler::getInstance().getJobs().size()) + " job(s) active)");
+}
+
 void registerCommands() {
     auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
     
@@ -58,6 +377,7 @@ void registerCommands() {
     auto& loadCmd = cmdRegistrar.getOrCreateCommand("waload", "Load a schematic file", CommandPermissionLevel::GameDirectors);
     loadCmd.overload<WaLoadParams>()
         .required("filename")
+        .optional("mode")
         .execute([&logger](CommandOrigin const& origin, CommandOutput& output, WaLoadParams const& params) {
             // Get player
             auto* entity = origin.getEntity();
@@ -67,7 +387,6 @@ void registerCommands() {
             }
             
             Player* player = static_cast<Player*>(entity);
-            std::string playerName = player->getRealName();
             
             // Build full path
             auto schemDir = WoodenAxeMod::getInstance().getSchematicDir();
@@ -80,6 +399,53 @@ void registerCommands() {
             
             std::string fullPath = (std::filesystem::path(schemDir) / filename).string();
             
+            // Prewarmed at startup: share the cached copy
+            if (params.mode != WaLoadMode::stream) {
+                if (auto cached = SchematicCache::getInstance().find(fullPath)) {
+                    output.success("§aLoaded schematic: §f" + filename + " §7(prewarmed)");
+                    output.success("§7Size: " + std::to_string(cached->width) + "x"
+                                   + std::to_string(cached->height) + "x" + std::to_string(cached->length));
+                    if (cached->occupancy.known) {
+                        output.success("§7Content: " + formatContent(cached->occupancy));
+                    }
+                    SessionStore::getInstance().getOrCreate(*player)->setClipboard(std::move(cached));
+                    return;
+                }
+            }
+            
+            // Large files keep only the header in memory; the scan runs off the server thread
+            const auto& config = WoodenAxeMod::getInstance().getConfig();
+            std::error_code sizeError;
+            auto fileSize = std::filesystem::file_size(fullPath, sizeError);
+            bool stream = params.mode == WaLoadMode::stream
+                       || (config.streamFileSizeMB > 0 && !sizeError
+                           && fileSize >= config.streamFileSizeMB * 1024 * 1024);
+            if (stream) {
+                auto session = SessionStore::getInstance().getOrCreate(*player);
+                mce::UUID playerUuid = player->getUuid();
+                WorkerPool::getInstance().submit([session, fullPath, filename, playerUuid] {
+                    auto header = SchematicReader::loadHeaderFromFile(fullPath);
+                    std::shared_ptr<const Schematic> schem;
+                    if (header) {
+                        schem = std::make_shared<const Schematic>(std::move(*header));
+                    }
+                    
+                    ll::thread::ServerThreadExecutor::getDefault().execute([session, schem, filename, playerUuid] {
+                        if (!schem) {
+                            notifyPlayer(playerUuid, "§cFailed to load schematic: " + filename);
+                            return;
+                        }
+                        session->setClipboard(schem);
+                        notifyPlayer(playerUuid, "§aLoaded schematic: §f" + filename + " §7("
+                                                     + std::to_string(schem->width) + "x"
+                                                     + std::to_string(schem->height) + "x"
+                                                     + std::to_string(schem->length) + ", streamed from disk)");
+                    });
+                });
+                output.success("§7Scanning " + filename + " for streaming...");
+                return;
+            }
+            
             // Load schematic
             auto schem = SchematicReader::loadFromFile(fullPath);
             if (!schem) {
@@ -87,19 +453,65 @@ void registerCommands() {
                 return;
             }
             
-            // Store in placer
-            SchematicPlacer::getInstance().setLoadedSchematic(playerName, std::move(*schem));
-            
             output.success("§aLoaded schematic: §f" + filename);
             output.success("§7Size: " + std::to_string(schem->width) + "x" + 
                           std::to_string(schem->height) + "x" + std::to_string(schem->length));
+            if (schem->occupancy.known) {
+                output.success("§7Content: " + formatContent(schem->occupancy));
+            }
+            
+            // Store in the player's session, then make room under the memory cap
+            auto& store = SessionStore::getInstance();
+            store.getOrCreate(*player)->setClipboard(std::make_shared<const Schematic>(std::move(*schem)));
+            store.enforceMemoryLimit();
         });
     
     // /wa paste - Paste loaded schematic at pos1
     auto& pasteCmd = cmdRegistrar.getOrCreateCommand("wapaste", "Paste schematic at pos1", CommandPermissionLevel::GameDirectors);
     pasteCmd.overload<WaPasteParams>()
-        .execute([&logger](CommandOrigin const& origin, CommandOutput& output, WaPasteParams const&) {
-            // Get player
+        .optional("priority")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaPasteParams const& params) {
+            queuePaste(origin, output, params.priority, PasteMask());
+        });
+    
+    // /wapaste air - Only write where the world has air
+    pasteCmd.overload<WaPasteAirParams>()
+        .required("mask")
+        .optional("priority")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaPasteAirParams const& params) {
+            PasteMask mask;
+            mask.onlyIntoAir = true;
+            queuePaste(origin, output, params.priority, std::move(mask));
+        });
+    
+    // /wapaste keep|only <blocks> - Protect world blocks, or write only some schematic blocks
+    pasteCmd.overload<WaPasteFilterParams>()
+        .required("filter")
+        .required("blocks")
+        .optional("priority")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaPasteFilterParams const& params) {
+            PasteMask mask;
+            auto& set = params.filter == WaPasteFilter::keep ? mask.keep : mask.only;
+            std::string unknown;
+            if (!set.parse(params.blocks, unknown)) {
+                output.error("Unknown block: " + (unknown.empty() ? params.blocks : unknown));
+                return;
+            }
+            queuePaste(origin, output, params.priority, std::move(mask));
+        });
+    
+    // /wapaste clip - Only the part that lands inside the pos1/pos2 box
+    pasteCmd.overload<WaPasteClipParams>()
+        .required("clip")
+        .optional("priority")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaPasteClipParams const& params) {
+            queuePaste(origin, output, params.priority, PasteMask(), true);
+        });
+    
+    // /wapaste dryrun - Report what a paste would cost, without writing
+    pasteCmd.overload<WaPasteDryRunParams>()
+        .required("mode")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaPasteDryRunParams const&) {
             auto* entity = origin.getEntity();
             if (!entity || !entity->isPlayer()) {
                 output.error("This command can only be used by players");
@@ -107,35 +519,129 @@ void registerCommands() {
             }
             
             Player* player = static_cast<Player*>(entity);
-            std::string playerName = player->getRealName();
+            auto session = SessionStore::getInstance().getOrCreate(*player);
             
-            // Get selection
-            auto selection = WoodenAxeMod::getInstance().getSelection(playerName);
-            if (!selection || !selection->pos1) {
+            auto selection = session->getSelection();
+            if (!selection.pos1) {
                 output.error("Please set pos1 first (left-click with wooden axe)");
                 return;
             }
             
-            // Get schematic
-            auto* schem = SchematicPlacer::getInstance().getLoadedSchematic(playerName);
-            if (!schem) {
-                output.error("No schematic loaded. Use /waload <filename> first");
+            withClipboard(
+                output, player->getUuid(), session,
+                [selection](std::shared_ptr<const Schematic> schem, const CommandReply& reply) {
+                    if (schem->stream) {
+                        reply.error("Dry run needs the blocks in memory; this schematic is streamed from disk");
+                        return;
+                    }
+                    
+                    auto& pos = *selection.pos1;
+                    auto sink = makeDimensionSink(selection.dimension);
+                    auto estimate = SchematicPlacer::getInstance().estimate(*schem, pos.x, pos.y, pos.z, *sink);
+                    
+                    // Duration at the budget the scheduler would use right now, 20 ticks per second
+                    const auto& config = WoodenAxeMod::getInstance().getConfig();
+                    size_t budget = config.adaptiveBudget
+                                      ? JobScheduler::getInstance().getBudgetController().getBudget()
+                                      : config.blocksPerTick;
+                    size_t work = estimate.blocks + estimate.blockEntities;
+                    size_t ticks = budget > 0 ? (work + budget - 1) / budget : 0;
+                    
+                    reply.success("§eDry run at (" + std::to_string(pos.x) + ", " + std::to_string(pos.y) + ", "
+                                  + std::to_string(pos.z) + "):");
+                    reply.success("  §7Blocks: §f" + std::to_string(estimate.blocks) + " §7(skipped "
+                                  + std::to_string(estimate.skipped) + ", unresolved "
+                                  + std::to_string(estimate.failed) + ")");
+                    reply.success("  §7Block entities: §f" + std::to_string(estimate.blockEntities));
+                    if (schem->occupancy.known) {
+                        reply.success("  §7Content: " + formatContent(schem->occupancy));
+                    }
+                    reply.success("  §7Chunks: §f" + std::to_string(estimate.chunks) + " §7Subchunks: §f"
+                                  + std::to_string(estimate.subchunks));
+                    reply.success("  §7Estimated time: §f" + std::to_string(ticks) + " §7ticks (~"
+                                  + std::to_string(ticks / 20) + " s at " + std::to_string(budget) + " blocks/tick)");
+                    
+                    // The largest offenders are enough to act on
+                    constexpr size_t kMaxListed = 10;
+                    for (size_t i = 0; i < estimate.unresolved.size() && i < kMaxListed; i++) {
+                        const auto& [name, count] = estimate.unresolved[i];
+                        reply.success("  §cUnresolved: §f" + name + " §7x" + std::to_string(count));
+                    }
+                    if (estimate.unresolved.size() > kMaxListed) {
+                        reply.success("  §7... and " + std::to_string(estimate.unresolved.size() - kMaxListed)
+                                      + " more unresolved palette entries");
+                    }
+                }
+            );
+        });
+    
+    // /wastamp - Paste a grid of copies of the loaded schematic from pos1
+    auto& stampCmd = cmdRegistrar.getOrCreateCommand("wastamp", "Paste a grid of copies at pos1", CommandPermissionLevel::GameDirectors);
+    stampCmd.overload<WaStampParams>()
+        .required("countX")
+        .required("countZ")
+        .required("spacing")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaStampParams const& params) {
+            auto* entity = origin.getEntity();
+            if (!entity || !entity->isPlayer()) {
+                output.error("This command can only be used by players");
                 return;
             }
             
-            // Paste
-            auto& pos = *selection->pos1;
-            int dim = selection->dimension;
+            constexpr int kMaxCopies = 4096;
+            if (params.countX < 1 || params.countZ < 1 || params.spacing < 0) {
+                output.error("Counts must be at least 1 and spacing at least 0");
+                return;
+            }
+            if (params.countX * static_cast<long long>(params.countZ) > kMaxCopies) {
+                output.error("At most " + std::to_string(kMaxCopies) + " copies per stamp");
+                return;
+            }
             
-            int placed = SchematicPlacer::getInstance().placeSchematic(
-                *schem, pos.x, pos.y, pos.z, dim
-            );
+            Player* player = static_cast<Player*>(entity);
+            auto session = SessionStore::getInstance().getOrCreate(*player);
             
-            if (placed > 0) {
-                output.success("§aPasted " + std::to_string(placed) + " blocks");
-            } else {
-                output.error("Failed to paste schematic");
+            auto selection = session->getSelection();
+            if (!selection.pos1) {
+                output.error("Please set pos1 first (left-click with wooden axe)");
+                return;
             }
+            
+            mce::UUID playerUuid = player->getUuid();
+            int copies = params.countX * params.countZ;
+            
+            PasteOptions options = makePasteOptions(WoodenAxeMod::getInstance().getConfig());
+            
+            withClipboard(
+                output, playerUuid, session,
+                [session, selection, params, options, playerUuid, copies](
+                    std::shared_ptr<const Schematic> schem, const CommandReply& reply
+                ) {
+                    if (schem->stream) {
+                        reply.error("Stamping needs the blocks in memory; this schematic is streamed from disk");
+                        return;
+                    }
+                    
+                    auto& pos = *selection.pos1;
+                    auto job = SchematicPlacer::getInstance().stampAsync(
+                        std::move(schem), pos.x, pos.y, pos.z, params.countX, params.countZ, params.spacing,
+                        makeDimensionSink(selection.dimension), session->getName(), options,
+                        [playerUuid, copies](const PlaceResult& result) {
+                            if (result.ok && result.placed > 0) {
+                                notifyPlayer(playerUuid, "§aStamped " + std::to_string(copies) + " copies, "
+                                                             + std::to_string(result.placed) + " blocks");
+                            } else {
+                                notifyPlayer(playerUuid, "§cFailed to stamp schematic");
+                            }
+                        }
+                    );
+                    
+                    session->addJob(job);
+                    
+                    reply.success("§7Stamping " + std::to_string(copies) + " copies... (job #"
+                                  + std::to_string(job->getId()) + ")");
+                }
+            );
         });
     
     // /wa pos - Show current selection
@@ -149,24 +655,24 @@ void registerCommands() {
             }
             
             Player* player = static_cast<Player*>(entity);
-            std::string playerName = player->getRealName();
             
-            auto selection = WoodenAxeMod::getInstance().getSelection(playerName);
-            if (!selection) {
+            auto session = SessionStore::getInstance().find(getPlayerId(*player));
+            auto selection = session ? session->getSelection() : PlayerSelection{};
+            if (!selection.pos1 && !selection.pos2) {
                 output.success("No selection set");
                 return;
             }
             
-            if (selection->pos1) {
-                auto& p = *selection->pos1;
+            if (selection.pos1) {
+                auto& p = *selection.pos1;
                 output.success("§ePos1: §f(" + std::to_string(p.x) + ", " + 
                               std::to_string(p.y) + ", " + std::to_string(p.z) + ")");
             } else {
                 output.success("§ePos1: §7Not set");
             }
             
-            if (selection->pos2) {
-                auto& p = *selection->pos2;
+            if (selection.pos2) {
+                auto& p = *selection.pos2;
                 output.success("§ePos2: §f(" + std::to_string(p.x) + ", " + 
                               std::to_string(p.y) + ", " + std::to_string(p.z) + ")");
             } else {
@@ -185,15 +691,151 @@ void registerCommands() {
             }
             
             Player* player = static_cast<Player*>(entity);
-            std::string playerName = player->getRealName();
             
-            WoodenAxeMod::getInstance().clearSelection(playerName);
-            SchematicPlacer::getInstance().clearLoadedSchematic(playerName);
+            if (auto session = SessionStore::getInstance().find(getPlayerId(*player))) {
+                session->clearSelection();
+                session->setClipboard(nullptr);
+            }
             
             output.success("§aSelection and loaded schematic cleared");
         });
     
-    logger.info("Commands registered: /walist, /waload, /wapaste, /wapos, /waclear");
+    // /waset <block> - Fill the selection
+    auto& setCmd = cmdRegistrar.getOrCreateCommand("waset", "Fill selection with a block", CommandPermissionLevel::GameDirectors);
+    setCmd.overload<WaSetParams>()
+        .required("block")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaSetParams const& params) {
+            queueRegionFill(origin, output, params.block, "");
+        });
+    
+    // /wareplace <from> <to> - Replace blocks inside the selection
+    auto& replaceCmd = cmdRegistrar.getOrCreateCommand("wareplace", "Replace blocks in selection", CommandPermissionLevel::GameDirectors);
+    replaceCmd.overload<WaReplaceParams>()
+        .required("from")
+        .required("to")
+        .execute([](CommandOrigin const& origin, CommandOutput& output, WaReplaceParams const& params) {
+            queueRegionFill(origin, output, params.to, params.from);
+        });
+    
+    // /wajobs - List queued and running jobs
+    auto& jobsCmd = cmdRegistrar.getOrCreateCommand("wajobs", "List world edit jobs", CommandPermissionLevel::GameDirectors);
+    jobsCmd.overload<WaJobsParams>()
+        .execute([](CommandOrigin const&, CommandOutput& output, WaJobsParams const&) {
+            auto& scheduler = JobScheduler::getInstance();
+            const auto& jobs = scheduler.getJobs();
+            
+            const auto& controller = scheduler.getBudgetController();
+            if (WoodenAxeMod::getInstance().getConfig().adaptiveBudget) {
+                output.success("§7Budget: §f" + std::to_string(controller.getBudget()) + " §7blocks/tick (slice "
+                               + std::to_string(static_cast<int>(controller.getSliceMs())) + " ms, tick "
+                               + std::to_string(static_cast<int>(controller.getTickMs())) + " ms)");
+            }
+            
+            if (jobs.empty()) {
+                output.success("No jobs queued");
+                return;
+            }
+            
+            output.success("§eJobs:");
+            for (const auto& job : jobs) {
+                size_t total = job->getTotalWork();
+                size_t percent = total > 0 ? job->getDoneWork() * 100 / total : 0;
+                output.success("  §7#" + std::to_string(job->getId()) + " §f" + job->getOwner() + " §7["
+                               + getStateName(job->getState()) + ", " + getPriorityName(job->getPriority()) + "] §f"
+                               + job->describe() + " §7" + std::to_string(percent) + "%");
+            }
+        });
+    
+    // /wacancel <id>, /wapause <id>, /waresume <id> - Control a job
+    auto& cancelCmd = cmdRegistrar.getOrCreateCommand("wacancel", "Cancel a world edit job", CommandPermissionLevel::GameDirectors);
+    cancelCmd.overload<WaJobIdParams>()
+        .required("id")
+        .execute([](CommandOrigin const&, CommandOutput& output, WaJobIdParams const& params) {
+            if (JobScheduler::getInstance().cancel(static_cast<uint64_t>(params.id))) {
+                output.success("§aCancelled job #" + std::to_string(params.id));
+            } else {
+                output.error("No active job #" + std::to_string(params.id));
+            }
+        });
+    
+    auto& pauseCmd = cmdRegistrar.getOrCreateCommand("wapause", "Pause a world edit job", CommandPermissionLevel::GameDirectors);
+    pauseCmd.overload<WaJobIdParams>()
+        .required("id")
+        .execute([](CommandOrigin const&, CommandOutput& output, WaJobIdParams const& params) {
+            if (JobScheduler::getInstance().pause(static_cast<uint64_t>(params.id))) {
+                output.success("§aPaused job #" + std::to_string(params.id));
+            } else {
+                output.error("No running job #" + std::to_string(params.id));
+            }
+        });
+    
+    auto& resumeCmd = cmdRegistrar.getOrCreateCommand("waresume", "Resume a paused job", CommandPermissionLevel::GameDirectors);
+    resumeCmd.overload<WaJobIdParams>()
+        .required("id")
+        .execute([](CommandOrigin const&, CommandOutput& output, WaJobIdParams const& params) {
+            if (JobScheduler::getInstance().resume(static_cast<uint64_t>(params.id))) {
+                output.success("§aResumed job #" + std::to_string(params.id));
+            } else {
+                output.error("No paused job #" + std::to_string(params.id));
+            }
+        });
+    
+    // /wastats - Clipboard memory per player
+    auto& statsCmd = cmdRegistrar.getOrCreateCommand("wastats", "Show clipboard memory usage", CommandPermissionLevel::GameDirectors);
+    statsCmd.overload<WaStatsParams>()
+        .execute([](CommandOrigin const&, CommandOutput& output, WaStatsParams const&) {
+            auto& store = SessionStore::getInstance();
+            const auto& config = WoodenAxeMod::getInstance().getConfig();
+            auto now = std::chrono::steady_clock::now();
+            
+            output.success("§eClipboard memory: §f" + formatBytes(store.getClipboardMemory()) + " §7/ "
+                           + std::to_string(config.clipboardMemoryLimitMB) + " MB");
+            auto& cache = SchematicCache::getInstance();
+            if (cache.getEntryCount() > 0) {
+                output.success("§ePrewarmed: §f" + formatBytes(cache.getMemoryUsage()) + " §7in "
+                               + std::to_string(cache.getEntryCount()) + " schematics");
+            }
+            
+            for (const auto& session : store.getAll()) {
+                auto usage = session->getClipboardUsage();
+                std::string state;
+                if (usage.residentBytes > 0) {
+                    state = "§f" + formatBytes(usage.residentBytes);
+                } else if (usage.spilled) {
+                    state = "§7on disk §f" + formatBytes(usage.spilledBytes);
+                } else if (usage.dropped) {
+                    state = "§7unloaded";
+                } else {
+                    continue; // No clipboard
+                }
+                
+                auto idle = std::chrono::duration_cast<std::chrono::minutes>(now - usage.lastUsed).count();
+                output.success("  §f" + session->getName() + " §7" + state + " §7(idle "
+                               + std::to_string(idle) + " min, " + std::to_string(session->getActiveJobs().size())
+                               + " job(s))");
+            }
+        });
+    
+    // /watrace on|off - Write a Chrome trace of every load and paste
+    auto& traceCmd = cmdRegistrar.getOrCreateCommand("watrace", "Trace schematic loads and pastes", CommandPermissionLevel::GameDirectors);
+    traceCmd.overload<WaTraceParams>()
+        .required("mode")
+        .execute([](CommandOrigin const&, CommandOutput& output, WaTraceParams const& params) {
+            auto& tracer = Tracer::getInstance();
+            if (params.mode == WaTraceMode::off) {
+                tracer.setEnabled(false);
+                output.success("§aTracing off; loads and pastes already running still write their trace");
+                return;
+            }
+            if (!tracer.setEnabled(true)) {
+                output.error("This build has no trace zones; rebuild with xmake f --trace=y");
+                return;
+            }
+            output.success("§aTracing on: each load and paste writes a trace to §f" + tracer.getTraceDir().string());
+        });
+    
+    logger.info("Commands registered: /walist, /waload, /wapaste, /wastamp, /wapos, /waclear, /waset, /wareplace, "
+                "/wajobs, /wacancel, /wapause, /waresume, /wastats, /watrace");
 }
 
 } // namespace wooden_axe
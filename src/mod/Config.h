@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wooden_axe {
+
+// Persisted as config/config.json, loaded in WoodenAxeMod::load()
+struct Config {
+    int version = 2;
+
+    // Item used to set pos1/pos2, resolved to its numeric id when the mod is enabled
+    std::string selectionTool = "minecraft:wooden_axe";
+
+    // World writes performed per server tick by queued jobs (fill, replace, paste).
+    // With adaptiveBudget this is only the starting point.
+    size_t blocksPerTick = 20000;
+
+    // Resize the budget every tick from measured slice and tick times
+    bool adaptiveBudget = true;
+    double targetMspt = 50.0;
+    double maxSliceMs = 10.0;
+    size_t minBlocksPerTick = 256;
+    size_t maxBlocksPerTick = 200000;
+
+    // Chunks a paste keeps requested ahead of the one being written
+    size_t preloadChunks = 16;
+    // A chunk still not loaded after this long is counted as failed
+    int chunkLoadTimeoutSeconds = 30;
+    // Pastes write 16x16x16 sections they fully cover straight into the chunk, without
+    // per-block neighbour updates or listeners (redstone, liquids and other mods do not see
+    // them). Clients get each section in one subchunk packet, so this needs
+    // coalesceClientUpdates. Off until measured and verified in game.
+    bool bulkSectionWrites = false;
+    // Pastes skip per-block client updates and, once a chunk is written, send one
+    // UpdateSubChunkBlocks packet per changed subchunk. Off until verified in game.
+    bool coalesceClientUpdates = false;
+
+    // Clipboards over this total are evicted least recently used first
+    size_t clipboardMemoryLimitMB = 1024;
+    // Evict clipboards unused for this long (0 = only when over the limit)
+    int clipboardIdleMinutes = 30;
+    // Evicted clipboards go to a compact file and come back on next use; otherwise they are dropped
+    bool spillClipboardsToDisk = true;
+
+    // /waload streams files at least this large: only the palette and block entities are
+    // kept, blocks are decoded from the file at paste time (0 = only with the stream option)
+    size_t streamFileSizeMB = 256;
+    // Voxels decoded and planned at once by a streamed paste
+    size_t streamWindowBlocks = 4194304;
+
+    // Schematic files (relative to the schematics directory) loaded in the background when the
+    // mod is enabled and shared by every /waload of them
+    std::vector<std::string> prewarmSchematics;
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,212 @@
+#include "mod/WorldSink.h"
+#include "mod/WoodenAxeMod.h"
+
+#include "ll/api/service/Bedrock.h"
+#include "mc/dataloadhelper/DefaultDataLoadHelper.h"
+#include "mc/nbt/CompoundTag.h"
+#include "mc/network/NetworkBlockPosition.h"
+#include "mc/network/packet/UpdateSubChunkBlocksPacket.h"
+#include "mc/world/level/BlockPos.h"
+#include "mc/world/level/BlockSource.h"
+#include "mc/world/level/ChunkBlockPos.h"
+#include "mc/world/level/ChunkPos.h"
+#include "mc/world/level/Level.h"
+#include "mc/world/level/block/Block.h"
+#include "mc/world/level/block/actor/BlockActor.h"
+#include "mc/world/level/block/registry/BlockTypeRegistry.h"
+#include "mc/world/level/chunk/ChunkSource.h"
+#include "mc/world/level/chunk/LevelChunk.h"
+#include "mc/world/level/dimension/Dimension.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace wooden_axe {
+
+namespace {
+
+// BlockSource::setBlock update flags
+constexpr int kUpdateNeighbors = 1;
+constexpr int kUpdateClients = 2;
+
+class DimensionSink : public WorldSink {
+public:
+    explicit DimensionSink(int dimension) : mDimension(dimension) {}
+
+    const Block* resolveBlock(const std::string& name) override {
+        return BlockTypeRegistry::lookupByName(name, false);
+    }
+
+    uint32_t getBlockId(const Block& block) const override { return block.getRuntimeId(); }
+
+    std::string getBlockTypeName(const Block& block) const override { return block.getTypeName(); }
+
+    bool requestChunk(int chunkX, int chunkZ) override {
+        auto key = makeKey(chunkX, chunkZ);
+        if (mChunks.contains(key)) {
+            return true;
+        }
+        auto* dim = getDimension();
+        if (!dim) {
+            return false;
+        }
+
+        // Deferred: the chunk source generates or reads it from disk off the tick; not read-only, pastes write it
+        auto chunk = dim->getChunkSource().getOrLoadChunk(
+            ChunkPos(chunkX, chunkZ), ChunkSource::LoadMode::Deferred, false
+        );
+        mChunks.emplace(key, std::move(chunk));
+        return true;
+    }
+
+    bool isChunkReady(int chunkX, int chunkZ) override {
+        auto it = mChunks.find(makeKey(chunkX, chunkZ));
+        return it != mChunks.end() && it->second && it->second->isFullyLoaded();
+    }
+
+    void releaseChunk(int chunkX, int chunkZ) override { mChunks.erase(makeKey(chunkX, chunkZ)); }
+
+    bool beginChunk(int chunkX, int chunkZ) override {
+        auto* dim = getDimension();
+        if (!dim) {
+            return false;
+        }
+        mBlockSource = &dim->getBlockSourceFromMainChunkSource();
+        mMinHeight = dim->getMinHeight();
+        mChunkX = chunkX;
+        mChunkZ = chunkZ;
+        auto it = mChunks.find(makeKey(chunkX, chunkZ));
+        mLevelChunk = it != mChunks.end() ? it->second.get() : nullptr;
+        return true;
+    }
+
+    const Block* getBlock(int x, int y, int z) override { return &mBlockSource->getBlock(::BlockPos(x, y, z)); }
+
+    bool setBlock(int x, int y, int z, const Block& block, bool updateClients) override {
+        int flags = updateClients ? kUpdateNeighbors | kUpdateClients : kUpdateNeighbors;
+        if (!mBlockSource->setBlock(::BlockPos(x, y, z), block, flags, nullptr, nullptr)) {
+            return false;
+        }
+        if (!updateClients) {
+            mDirtyBlocks.emplace_back(BlockCommand::pack(x & 15, y, z & 15), &block);
+        }
+        return true;
+    }
+
+    size_t endChunk() override {
+        // Every silent write of a subchunk goes out in one UpdateSubChunkBlocks packet, to the
+        // players that can see it. Writes arrive Y-ordered, so the sort rarely moves anything;
+        // it is stable so a position written twice ends with its last block.
+        size_t refreshed = 0;
+        auto* dim = getDimension();
+        if (dim) {
+            std::stable_sort(mDirtyBlocks.begin(), mDirtyBlocks.end(), [](const auto& a, const auto& b) {
+                return getSectionY(a.first) < getSectionY(b.first);
+            });
+            for (size_t begin = 0; begin < mDirtyBlocks.size(); refreshed++) {
+                int section = getSectionY(mDirtyBlocks[begin].first);
+                ::BlockPos origin(mChunkX * 16, section * 16, mChunkZ * 16);
+                UpdateSubChunkBlocksPacket packet;
+                packet.mSubChunkBlockPosition = NetworkBlockPosition(origin);
+                for (; begin < mDirtyBlocks.size() && getSectionY(mDirtyBlocks[begin].first) == section; begin++) {
+                    const auto& [packedPos, block] = mDirtyBlocks[begin];
+                    BlockCommand command{packedPos, 0};
+                    ::BlockPos pos(origin.x + command.localX(), command.worldY(), origin.z + command.localZ());
+                    packet.mBlocksChanged.mStandards.push_back(
+                        {NetworkBlockPosition(pos), block->getRuntimeId(), kUpdateNeighbors | kUpdateClients, {}}
+                    );
+                }
+                dim->sendPacketForPosition(origin, packet, nullptr);
+            }
+        }
+        mDirtyBlocks.clear();
+        mBlockSource = nullptr;
+        mLevelChunk = nullptr;
+        return refreshed;
+    }
+
+    size_t writeSection(int chunkX, int chunkZ, const BlockCommand* commands,
+                        const std::vector<const Block*>& blocks) override {
+        if (!mLevelChunk) {
+            return WorldSink::writeSection(chunkX, chunkZ, commands, blocks);
+        }
+        auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+
+        // Straight into the chunk, issued by the BlockSource so block actors are still
+        // created, but without its per-block neighbour updates, listeners and packets.
+        // Clients get the whole section in the one subchunk packet endChunk sends.
+        size_t written = 0;
+        for (size_t i = 0; i < ChunkCommandBuffer::kSectionVolume; i++) {
+            const auto& command = commands[i];
+            ::BlockPos pos(chunkX * 16 + command.localX(), command.worldY(), chunkZ * 16 + command.localZ());
+            try {
+                mLevelChunk->setBlock(ChunkBlockPos(pos, mMinHeight), *blocks[command.blockIndex], mBlockSource,
+                                      nullptr);
+                mDirtyBlocks.emplace_back(command.packedPos, blocks[command.blockIndex]);
+                written++;
+            } catch (const std::exception& e) {
+                logger.debug("Failed to place block at ({}, {}, {}): {}", pos.x, pos.y, pos.z, e.what());
+            }
+        }
+        mLevelChunk->setUnsaved();
+        return written;
+    }
+
+    bool loadBlockEntity(int x, int y, int z, const std::string& nbt) override {
+        auto* level = ll::service::getLevel();
+        auto* dim = getDimension();
+        if (!level || !dim) {
+            return false;
+        }
+        auto& blockSource = dim->getBlockSourceFromMainChunkSource();
+
+        ::BlockPos pos(x, y, z);
+        auto* blockActor = blockSource.getBlockEntity(pos);
+        if (!blockActor) {
+            return false;
+        }
+
+        auto tag = CompoundTag::fromBinaryNbt(nbt, true);
+        if (!tag) {
+            WoodenAxeMod::getInstance().getSelf().getLogger().debug(
+                "Invalid block entity data at ({}, {}, {})", x, y, z
+            );
+            return false;
+        }
+
+        DefaultDataLoadHelper dataLoadHelper;
+        blockActor->load(*level, *tag, dataLoadHelper);
+        blockActor->refresh(blockSource);
+        return true;
+    }
+
+private:
+    static uint64_t makeKey(int chunkX, int chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkZ);
+    }
+
+    Dimension* getDimension() const {
+        auto* level = ll::service::getLevel();
+        return level ? level->getDimension(mDimension).get() : nullptr;
+    }
+
+    static int getSectionY(uint32_t packedPos) { return BlockCommand{packedPos, 0}.worldY() >> 4; }
+
+    int mDimension;
+    std::unordered_map<uint64_t, std::shared_ptr<LevelChunk>> mChunks; // Held until released
+
+    // Open chunk
+    BlockSource* mBlockSource = nullptr;
+    LevelChunk* mLevelChunk = nullptr;
+    short mMinHeight = 0;
+    int mChunkX = 0;
+    int mChunkZ = 0;
+    std::vector<std::pair<uint32_t, const Block*>> mDirtyBlocks; // Written without client updates, packed local
+};
+
+} // namespace
+
+std::shared_ptr<WorldSink> makeDimensionSink(int dimension) { return std::make_shared<DimensionSink>(dimension); }
+
+} // namespace wooden_axe
@@ -1,4 +1,5 @@
 #include "mod/EventHandlers.h"
+#include "mod/SessionStore.h"
 #include "mod/WoodenAxeMod.h"
 
 #include "ll/api/event/EventBus.h"
@@ -9,31 +10,46 @@
 #include "mc/world/actor/player/Player.h"
 #include "mc/world/item/ItemStack.h"
 
+#include <string>
+
 namespace wooden_axe {
 
 static ll::event::ListenerPtr interactListener;
 static ll::event::ListenerPtr destroyListener;
 
-// Check if player is holding wooden axe
-static bool isHoldingWoodenAxe(Player& player) {
-    // Get the item in main hand
-    const auto& item = player.getSelectedItem();
-    
-    // Check if it's a wooden axe
-    std::string itemName = item.getTypeName();
-    return itemName == "minecraft:wooden_axe";
+// Numeric item id of the selection tool, resolved once when the handlers are registered
+static short toolId = 0;
+
+static short resolveTool(const std::string& name) {
+    ItemStack tool(name, 1, 0, nullptr);
+    return tool.isNull() ? 0 : tool.getId();
 }
 
+// Runs for every interaction of every player, so it is one id comparison with no allocation
+static bool isHoldingTool(Player& player) { return player.getSelectedItem().getId() == toolId; }
+
 void registerEventHandlers() {
     auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
     auto& eventBus = ll::event::EventBus::getInstance();
     
+    const auto& toolName = WoodenAxeMod::getInstance().getConfig().selectionTool;
+    toolId = resolveTool(toolName);
+    if (toolId == 0) {
+        logger.warn("Unknown selection tool {}, using minecraft:wooden_axe", toolName);
+        toolId = resolveTool("minecraft:wooden_axe");
+    }
+    if (toolId == 0) {
+        logger.error("No selection tool available, selection events are disabled");
+        return; // An empty hand has id 0 too
+    }
+    
     // Right-click event - set pos2
     interactListener = eventBus.emplaceListener<ll::event::player::PlayerInteractBlockEvent>(
         [&logger](ll::event::player::PlayerInteractBlockEvent& event) {
             auto& player = event.self();
             
-            if (!isHoldingWoodenAxe(player)) {
+            // Cheapest first: most interactions are not with the tool
+            if (!isHoldingTool(player)) {
                 return;
             }
             
@@ -43,13 +59,14 @@ void registerEventHandlers() {
             }
             
             auto blockPos = event.blockPos();
-            std::string playerName = player.getRealName();
             int dim = player.getDimensionId().id;
             
+            // Keyed by UUID: no name string is built or hashed here
+            auto session = SessionStore::getInstance().getOrCreate(player);
             BlockPos pos(blockPos.x, blockPos.y, blockPos.z);
-            WoodenAxeMod::getInstance().setPos2(playerName, pos, dim);
+            session->setPos2(pos, dim);
             
-            logger.debug("Player {} set pos2: ({}, {}, {})", playerName, pos.x, pos.y, pos.z);
+            logger.debug("Player {} set pos2: ({}, {}, {})", session->getName(), pos.x, pos.y, pos.z);
             
             // Send message to player
             player.sendMessage("§aPos2 set to ({}, {}, {})", pos.x, pos.y, pos.z);
@@ -64,7 +81,8 @@ void registerEventHandlers() {
         [&logger](ll::event::player::PlayerDestroyBlockEvent& event) {
             auto& player = event.self();
             
-            if (!isHoldingWoodenAxe(player)) {
+            // Cheapest first: most interactions are not with the tool
+            if (!isHoldingTool(player)) {
                 return;
             }
             
@@ -74,13 +92,14 @@ void registerEventHandlers() {
             }
             
             auto blockPos = event.pos();
-            std::string playerName = player.getRealName();
             int dim = player.getDimensionId().id;
             
+            // Keyed by UUID: no name string is built or hashed here
+            auto session = SessionStore::getInstance().getOrCreate(player);
             BlockPos pos(blockPos.x, blockPos.y, blockPos.z);
-            WoodenAxeMod::getInstance().setPos1(playerName, pos, dim);
+            session->setPos1(pos, dim);
             
-            logger.debug("Player {} set pos1: ({}, {}, {})", playerName, pos.x, pos.y, pos.z);
+            logger.debug("Player {} set pos1: ({}, {}, {})", session->getName(), pos.x, pos.y, pos.z);
             
             // Send message to player
             player.sendMessage("§aPos1 set to ({}, {}, {})", pos.x, pos.y, pos.z);
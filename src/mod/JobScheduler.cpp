@@ -0,0 +1,148 @@
+#include "mod/JobScheduler.h"
+
+#include <algorithm>
+
+namespace wooden_axe {
+
+SchedulerSettings makeSchedulerSettings(const Config& config) {
+    return {
+        config.adaptiveBudget,
+        {config.targetMspt, config.maxSliceMs, config.blocksPerTick, config.minBlocksPerTick, config.maxBlocksPerTick}
+    };
+}
+
+void JobScheduler::start(const SchedulerSettings& settings) {
+    if (mRunning) {
+        return;
+    }
+    mRunning = true;
+    ++mGeneration;
+
+    mSettings = settings;
+    mBudgetController.setSettings(mSettings.budget);
+    mBudgetController.reset();
+}
+
+void JobScheduler::stop() {
+    mRunning = false;
+    ++mGeneration;
+    mJobs.clear();
+}
+
+uint64_t JobScheduler::submit(std::shared_ptr<TickJob> job, std::string owner, JobPriority priority) {
+    job->mId = mNextId++;
+    job->mOwner = std::move(owner);
+    job->mPriority = priority;
+    job->mState = JobState::Queued;
+    mJobs.push_back(job);
+    return job->mId;
+}
+
+std::shared_ptr<TickJob> JobScheduler::findJob(uint64_t id) const {
+    for (const auto& job : mJobs) {
+        if (job->mId == id) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool JobScheduler::cancel(uint64_t id) {
+    auto it = std::find_if(mJobs.begin(), mJobs.end(), [id](const auto& job) { return job->mId == id; });
+    if (it == mJobs.end()) {
+        return false;
+    }
+
+    auto job = *it;
+    mJobs.erase(it);
+    job->mState = JobState::Cancelled;
+    job->onCancelled();
+    return true;
+}
+
+bool JobScheduler::pause(uint64_t id) {
+    auto job = findJob(id);
+    if (!job || job->mState == JobState::Paused) {
+        return false;
+    }
+    job->mState = JobState::Paused;
+    return true;
+}
+
+bool JobScheduler::resume(uint64_t id) {
+    auto job = findJob(id);
+    if (!job || job->mState != JobState::Paused) {
+        return false;
+    }
+    job->mState = JobState::Queued;
+    return true;
+}
+
+void JobScheduler::tick() {
+    if (!mRunning) {
+        return;
+    }
+
+    // Sampled every tick, busy or not, so the tick interval stays meaningful
+    size_t budget = mSettings.adaptiveBudget ? mBudgetController.beginSlice() : mSettings.budget.initialBlocks;
+
+    std::vector<std::shared_ptr<TickJob>> runnable;
+    size_t totalWeight = 0;
+    for (const auto& job : mJobs) {
+        if (job->mState != JobState::Paused) {
+            runnable.push_back(job);
+            totalWeight += getWeight(job->mPriority);
+        }
+    }
+    if (runnable.empty()) {
+        mBudgetController.endSlice(0);
+        return;
+    }
+
+    size_t remaining = budget;
+    size_t count = runnable.size();
+    size_t start = mRoundRobinCursor++ % count;
+
+    // Pass 1: proportional share per job; pass 2: hand out what finished or idle jobs left over
+    for (int pass = 0; pass < 2 && remaining > 0; pass++) {
+        for (size_t k = 0; k < count && remaining > 0; k++) {
+            auto& job = runnable[(start + k) % count];
+            if (job->isFinished() || job->mState == JobState::Cancelled) {
+                continue;
+            }
+
+            size_t share = pass == 0 ? std::max<size_t>(1, budget * getWeight(job->mPriority) / totalWeight)
+                                     : remaining;
+            share = std::min(share, remaining);
+
+            job->mState = JobState::Running;
+            size_t used = job->runSlice(share);
+            remaining -= std::min(used, remaining);
+        }
+    }
+
+    mBudgetController.endSlice(budget - remaining);
+
+    // Retire finished jobs in submission order
+    std::vector<std::shared_ptr<TickJob>> finished;
+    mJobs.erase(
+        std::remove_if(
+            mJobs.begin(),
+            mJobs.end(),
+            [&](const std::shared_ptr<TickJob>& job) {
+                if (!job->isFinished()) {
+                    return false;
+                }
+                finished.push_back(job);
+                return true;
+            }
+        ),
+        mJobs.end()
+    );
+    for (auto& job : finished) {
+        job->mState = JobState::Finished;
+        job->onFinished();
+    }
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "mod/BudgetController.h"
+#include "mod/Config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace wooden_axe {
+
+enum class JobPriority : uint8_t {
+    Low = 0,
+    Normal = 1,
+    High = 2
+};
+
+enum class JobState : uint8_t {
+    Queued,
+    Running,
+    Paused,
+    Finished,
+    Cancelled
+};
+
+// Work that runs on the server thread a slice at a time
+class TickJob {
+public:
+    virtual ~TickJob() = default;
+
+    // Perform at most `budget` block operations, return how many were used
+    virtual size_t runSlice(size_t budget) = 0;
+
+    virtual bool isFinished() const = 0;
+
+    // Called once on the server thread after the last slice
+    virtual void onFinished() {}
+
+    // Called once on the server thread when the job is cancelled
+    virtual void onCancelled() {}
+
+    // Short human-readable summary for /wajobs
+    virtual std::string describe() const = 0;
+
+    virtual size_t getTotalWork() const = 0;
+    virtual size_t getDoneWork() const = 0;
+
+    uint64_t getId() const { return mId; }
+    JobPriority getPriority() const { return mPriority; }
+    JobState getState() const { return mState; }
+    const std::string& getOwner() const { return mOwner; }
+
+    bool isActive() const { return mState != JobState::Finished && mState != JobState::Cancelled; }
+
+private:
+    friend class JobScheduler;
+
+    uint64_t mId = 0;
+    JobPriority mPriority = JobPriority::Normal;
+    JobState mState = JobState::Queued;
+    std::string mOwner;
+};
+
+// How a JobScheduler sizes each tick's budget
+struct SchedulerSettings {
+    // Resize the budget every tick; otherwise budget.initialBlocks is used as is
+    bool adaptiveBudget = true;
+    BudgetSettings budget;
+};
+
+// Scheduler settings as the config sets them
+SchedulerSettings makeSchedulerSettings(const Config& config);
+
+// Scheduler for world-writing jobs; the plugin runs one for the whole server.
+// A single blocks-per-tick budget is shared between all runnable jobs with
+// weighted round-robin (weight by priority), so any number of concurrent
+// jobs costs the same per tick. The budget itself comes from BudgetController
+// unless adaptiveBudget is off. It has no loop of its own: whoever owns it calls tick() once
+// per server tick (WoodenAxeMod, or the bench harness), always from the same thread.
+class JobScheduler {
+public:
+    static JobScheduler& getInstance() {
+        static JobScheduler instance;
+        return instance;
+    }
+
+    // Reset the budget and start running jobs on tick()
+    void start(const SchedulerSettings& settings);
+    // Drop every job; tick() does nothing until the next start
+    void stop();
+
+    // One round: share this tick's budget between the runnable jobs and retire finished ones
+    void tick();
+
+    bool isRunning() const { return mRunning; }
+    // Bumped by start and stop, so a tick loop can tell it belongs to an earlier start
+    uint64_t getGeneration() const { return mGeneration; }
+
+    // Queue a job, returns its id
+    uint64_t submit(std::shared_ptr<TickJob> job, std::string owner, JobPriority priority = JobPriority::Normal);
+
+    bool cancel(uint64_t id);
+    bool pause(uint64_t id);
+    bool resume(uint64_t id);
+
+    std::shared_ptr<TickJob> findJob(uint64_t id) const;
+    const std::vector<std::shared_ptr<TickJob>>& getJobs() const { return mJobs; }
+
+    const BudgetController& getBudgetController() const { return mBudgetController; }
+
+private:
+    static size_t getWeight(JobPriority priority) { return size_t{1} << static_cast<int>(priority); }
+
+    std::vector<std::shared_ptr<TickJob>> mJobs;
+    BudgetController mBudgetController;
+    SchedulerSettings mSettings;
+    uint64_t mNextId = 1;
+    size_t mRoundRobinCursor = 0; // Rotates who gets the rounding remainder first
+    uint64_t mGeneration = 0;
+    bool mRunning = false;
+};
+
+} // namespace wooden_axe
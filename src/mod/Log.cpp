@@ -0,0 +1,38 @@
+#include "mod/Log.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace wooden_axe {
+
+namespace {
+
+std::mutex gMutex;
+std::shared_ptr<const Log::Handler> gHandler; // Guarded by gMutex; copied out before the call
+
+} // namespace
+
+void Log::setHandler(Handler handler) {
+    auto next = handler ? std::make_shared<const Handler>(std::move(handler)) : nullptr;
+    std::lock_guard lock(gMutex);
+    gHandler = std::move(next);
+}
+
+void Log::write(LogLevel level, const std::string& message) {
+    std::shared_ptr<const Handler> handler;
+    {
+        std::lock_guard lock(gMutex);
+        handler = gHandler;
+    }
+    if (handler) {
+        (*handler)(level, message);
+        return;
+    }
+    if (level != LogLevel::Debug) {
+        static constexpr const char* kNames[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+        std::fprintf(stderr, "[%s] %s\n", kNames[static_cast<size_t>(level)], message.c_str());
+    }
+}
+
+} // namespace wooden_axe
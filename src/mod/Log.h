@@ -0,0 +1,50 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace wooden_axe {
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error
+};
+
+// Logging for the code that also runs without a server (schematic reader, tracer), so it can be
+// built into the bench harness. WoodenAxeMod forwards it to the mod logger while enabled;
+// otherwise everything but debug output goes to stderr.
+class Log {
+public:
+    using Handler = std::function<void(LogLevel, const std::string&)>;
+
+    static void setHandler(Handler handler);
+    static void write(LogLevel level, const std::string& message);
+
+    template <typename... Args>
+    static void debug(fmt::format_string<Args...> format, Args&&... args) {
+        write(LogLevel::Debug, fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void info(fmt::format_string<Args...> format, Args&&... args) {
+        write(LogLevel::Info, fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void warn(fmt::format_string<Args...> format, Args&&... args) {
+        write(LogLevel::Warn, fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void error(fmt::format_string<Args...> format, Args&&... args) {
+        write(LogLevel::Error, fmt::format(format, std::forward<Args>(args)...));
+    }
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,149 @@
+#include "mod/MemoryWorldSink.h"
+
+#include <algorithm>
+
+namespace wooden_axe {
+
+MemoryWorldSink::MemoryWorldSink(size_t loadDelay, std::vector<std::string> known)
+: mLoadDelay(loadDelay),
+  mKnown(std::move(known)),
+  mAir(intern("minecraft:air")) {}
+
+const Block* MemoryWorldSink::intern(const std::string& name) {
+    auto it = mBlocks.find(name);
+    if (it != mBlocks.end()) {
+        return it->second;
+    }
+    const auto& record = mRecords.emplace_back(BlockRecord{name, static_cast<uint32_t>(mRecords.size())});
+    const Block* block = toHandle(record);
+    mBlocks.emplace(name, block);
+    return block;
+}
+
+uint32_t MemoryWorldSink::getBlockId(const Block& block) const {
+    return toRecord(block).id;
+}
+
+std::string MemoryWorldSink::getBlockTypeName(const Block& block) const {
+    const auto& name = toRecord(block).name;
+    return name.substr(0, name.find('['));
+}
+
+const Block* MemoryWorldSink::resolveBlock(const std::string& name) {
+    if (!mKnown.empty() && std::find(mKnown.begin(), mKnown.end(), name) == mKnown.end()) {
+        return nullptr;
+    }
+    return intern(name);
+}
+
+bool MemoryWorldSink::requestChunk(int chunkX, int chunkZ) {
+    auto& chunk = mChunks[makeKey(chunkX, chunkZ)];
+    if (!chunk.held) {
+        chunk.held = true;
+        chunk.pendingPolls = mLoadDelay;
+        mStats.chunkLoads++;
+    }
+    return true;
+}
+
+bool MemoryWorldSink::isChunkReady(int chunkX, int chunkZ) {
+    auto it = mChunks.find(makeKey(chunkX, chunkZ));
+    if (it == mChunks.end() || !it->second.held) {
+        return false;
+    }
+    if (it->second.pendingPolls > 0) {
+        it->second.pendingPolls--;
+        return false;
+    }
+    return true;
+}
+
+void MemoryWorldSink::releaseChunk(int chunkX, int chunkZ) {
+    auto it = mChunks.find(makeKey(chunkX, chunkZ));
+    if (it != mChunks.end()) {
+        it->second.held = false;
+    }
+}
+
+bool MemoryWorldSink::beginChunk(int chunkX, int chunkZ) {
+    mOpen = &mChunks[makeKey(chunkX, chunkZ)];
+    return true;
+}
+
+MemoryWorldSink::Section& MemoryWorldSink::getSection(Chunk& chunk, int sectionY) {
+    auto& section = chunk.sections[sectionY];
+    if (!section) {
+        section = std::make_unique<Section>();
+        section->fill(mAir);
+    }
+    return *section;
+}
+
+void MemoryWorldSink::markDirty(int worldY) {
+    int section = worldY >> 4;
+    if (mDirtySections.empty() || mDirtySections.back() != section) {
+        mDirtySections.push_back(section);
+    }
+}
+
+const Block* MemoryWorldSink::getBlock(int x, int y, int z) {
+    return getSection(*mOpen, y >> 4)[getSectionIndex(x, y, z)];
+}
+
+const Block* MemoryWorldSink::peekBlock(int x, int y, int z) const {
+    auto it = mChunks.find(makeKey(x >> 4, z >> 4));
+    if (it == mChunks.end()) {
+        return mAir;
+    }
+    auto section = it->second.sections.find(y >> 4);
+    return section != it->second.sections.end() ? (*section->second)[getSectionIndex(x, y, z)] : mAir;
+}
+
+bool MemoryWorldSink::setBlock(int x, int y, int z, const Block& block, bool updateClients) {
+    getSection(*mOpen, y >> 4)[getSectionIndex(x, y, z)] = &block;
+    mStats.blockWrites++;
+    if (updateClients) {
+        mStats.clientUpdates++;
+    } else {
+        markDirty(y);
+    }
+    return true;
+}
+
+size_t MemoryWorldSink::writeSection(int /*chunkX*/, int /*chunkZ*/, const BlockCommand* commands,
+                                     const std::vector<const Block*>& blocks) {
+    // The open chunk is the one being written
+    auto& section = getSection(*mOpen, commands[0].worldY() >> 4);
+    for (size_t i = 0; i < kSectionVolume; i++) {
+        const auto& command = commands[i];
+        section[getSectionIndex(command.localX(), command.worldY(), command.localZ())] = blocks[command.blockIndex];
+    }
+    mStats.blockWrites += kSectionVolume;
+    mStats.sectionWrites++;
+    markDirty(commands[0].worldY());
+    return kSectionVolume;
+}
+
+size_t MemoryWorldSink::endChunk() {
+    std::sort(mDirtySections.begin(), mDirtySections.end());
+    mDirtySections.erase(std::unique(mDirtySections.begin(), mDirtySections.end()), mDirtySections.end());
+    size_t refreshed = mDirtySections.size();
+    mStats.subchunkRefreshes += refreshed;
+    mDirtySections.clear();
+    mOpen = nullptr;
+    return refreshed;
+}
+
+bool MemoryWorldSink::loadBlockEntity(int x, int y, int z, const std::string& nbt) {
+    // Any placed block can hold data here; the server only has actors for some
+    auto& chunk = mChunks[makeKey(x >> 4, z >> 4)];
+    auto section = chunk.sections.find(y >> 4);
+    if (section == chunk.sections.end() || (*section->second)[getSectionIndex(x, y, z)] == mAir) {
+        return false;
+    }
+    chunk.blockEntities[(static_cast<uint32_t>(y) << 8) | static_cast<uint32_t>(getSectionIndex(x, 0, z))] = nbt;
+    mStats.blockEntities++;
+    return true;
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "mod/WorldSink.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wooden_axe {
+
+// A world kept in memory, chunk by chunk, that plans can be written into without a server
+// (bench/PipelineBench.cpp).
+// Its blocks are records of its own, one per resolved name, handed out as opaque Block pointers.
+// Only this sink turns such a pointer back into its record; nothing calls into it as a Block.
+class MemoryWorldSink : public WorldSink {
+public:
+    // Work done so far, to compare against what a paste reports
+    struct Stats {
+        size_t blockWrites = 0;
+        size_t sectionWrites = 0;
+        size_t clientUpdates = 0; // Blocks written with their own client update
+        size_t subchunkRefreshes = 0;
+        size_t chunkLoads = 0;
+        size_t blockEntities = 0;
+    };
+
+    // loadDelay: isChunkReady polls a requested chunk answers "not yet" before it loads.
+    // Names in `known` resolve; an empty list resolves every name.
+    explicit MemoryWorldSink(size_t loadDelay = 0, std::vector<std::string> known = {});
+
+    const Block* resolveBlock(const std::string& name) override;
+    uint32_t getBlockId(const Block& block) const override;
+    std::string getBlockTypeName(const Block& block) const override;
+
+    bool requestChunk(int chunkX, int chunkZ) override;
+    bool isChunkReady(int chunkX, int chunkZ) override;
+    void releaseChunk(int chunkX, int chunkZ) override;
+
+    bool beginChunk(int chunkX, int chunkZ) override;
+    const Block* getBlock(int x, int y, int z) override;
+    bool setBlock(int x, int y, int z, const Block& block, bool updateClients) override;
+    size_t endChunk() override;
+
+    size_t writeSection(int chunkX, int chunkZ, const BlockCommand* commands,
+                        const std::vector<const Block*>& blocks) override;
+
+    bool loadBlockEntity(int x, int y, int z, const std::string& nbt) override;
+
+    // Full name a block was resolved from, states included
+    const std::string& getBlockName(const Block& block) const { return toRecord(block).name; }
+
+    // Air for anything never written, including released chunks
+    const Block* getAir() const { return mAir; }
+
+    // Read a block at any time, outside beginChunk/endChunk
+    const Block* peekBlock(int x, int y, int z) const;
+
+    const Stats& getStats() const { return mStats; }
+    size_t getChunkCount() const { return mChunks.size(); }
+
+private:
+    static constexpr size_t kSectionVolume = 4096;
+
+    struct BlockRecord {
+        std::string name;
+        uint32_t id;
+    };
+    using Section = std::array<const Block*, kSectionVolume>;
+
+    struct Chunk {
+        std::unordered_map<int, std::unique_ptr<Section>> sections; // By section Y
+        std::unordered_map<uint32_t, std::string> blockEntities; // By in-chunk position
+        size_t pendingPolls = 0;
+        bool held = false;
+    };
+
+    static uint64_t makeKey(int chunkX, int chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkZ);
+    }
+
+    static size_t getSectionIndex(int x, int y, int z) {
+        return (static_cast<size_t>(y & 15) << 8) | (static_cast<size_t>(z & 15) << 4) | static_cast<size_t>(x & 15);
+    }
+
+    static const Block* toHandle(const BlockRecord& record) { return reinterpret_cast<const Block*>(&record); }
+    static const BlockRecord& toRecord(const Block& block) { return *reinterpret_cast<const BlockRecord*>(&block); }
+
+    const Block* intern(const std::string& name);
+    Section& getSection(Chunk& chunk, int sectionY);
+    void markDirty(int worldY);
+
+    size_t mLoadDelay;
+    std::vector<std::string> mKnown;
+    std::deque<BlockRecord> mRecords; // Ids are indices, addresses stay put
+    std::unordered_map<std::string, const Block*> mBlocks;
+    const Block* mAir;
+
+    // Chunks stay in memory once written; released only drops the hold
+    std::unordered_map<uint64_t, Chunk> mChunks;
+
+    // Open chunk
+    Chunk* mOpen = nullptr;
+    std::vector<int> mDirtySections;
+    Stats mStats;
+};
+
+} // namespace wooden_axe
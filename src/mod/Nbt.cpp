@@ -0,0 +1,297 @@
+#include "mod/Nbt.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace wooden_axe {
+
+namespace {
+
+constexpr int kMaxDepth = 512;
+
+void require(size_t size, size_t pos, size_t count) {
+    if (count > size || pos > size - count) {
+        throw std::runtime_error("NBT: Unexpected end of data");
+    }
+}
+
+uint64_t readBigEndian(const uint8_t* data, size_t size, size_t& pos, int bytes) {
+    require(size, pos, static_cast<size_t>(bytes));
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | data[pos + i];
+    }
+    pos += bytes;
+    return value;
+}
+
+int32_t readLength(const uint8_t* data, size_t size, size_t& pos) {
+    auto length = static_cast<int32_t>(readBigEndian(data, size, pos, 4));
+    if (length < 0) {
+        throw std::runtime_error("NBT: Negative length");
+    }
+    return length;
+}
+
+void skipPayload(const uint8_t* data, size_t size, size_t& pos, TagType type, int depth) {
+    if (depth > kMaxDepth) {
+        throw std::runtime_error("NBT: Nesting too deep");
+    }
+
+    switch (type) {
+    case TagType::End:
+        break;
+    case TagType::Byte:
+        require(size, pos, 1);
+        pos += 1;
+        break;
+    case TagType::Short:
+        require(size, pos, 2);
+        pos += 2;
+        break;
+    case TagType::Int:
+    case TagType::Float:
+        require(size, pos, 4);
+        pos += 4;
+        break;
+    case TagType::Long:
+    case TagType::Double:
+        require(size, pos, 8);
+        pos += 8;
+        break;
+    case TagType::ByteArray: {
+        size_t length = readLength(data, size, pos);
+        require(size, pos, length);
+        pos += length;
+        break;
+    }
+    case TagType::IntArray: {
+        size_t length = static_cast<size_t>(readLength(data, size, pos)) * 4;
+        require(size, pos, length);
+        pos += length;
+        break;
+    }
+    case TagType::LongArray: {
+        size_t length = static_cast<size_t>(readLength(data, size, pos)) * 8;
+        require(size, pos, length);
+        pos += length;
+        break;
+    }
+    case TagType::String: {
+        size_t length = static_cast<uint16_t>(readBigEndian(data, size, pos, 2));
+        require(size, pos, length);
+        pos += length;
+        break;
+    }
+    case TagType::List: {
+        require(size, pos, 1);
+        auto elementType = static_cast<TagType>(data[pos++]);
+        int32_t count = readLength(data, size, pos);
+        for (int32_t i = 0; i < count; i++) {
+            skipPayload(data, size, pos, elementType, depth + 1);
+        }
+        break;
+    }
+    case TagType::Compound:
+        while (true) {
+            require(size, pos, 1);
+            auto childType = static_cast<TagType>(data[pos++]);
+            if (childType == TagType::End) {
+                break;
+            }
+            // Name is skipped by length, never materialized
+            size_t nameLength = static_cast<uint16_t>(readBigEndian(data, size, pos, 2));
+            require(size, pos, nameLength);
+            pos += nameLength;
+            skipPayload(data, size, pos, childType, depth + 1);
+        }
+        break;
+    default:
+        throw std::runtime_error("NBT: Unknown tag type");
+    }
+}
+
+std::string readStringPayload(const uint8_t* data, size_t size, size_t& pos) {
+    size_t length = static_cast<uint16_t>(readBigEndian(data, size, pos, 2));
+    require(size, pos, length);
+    std::string result(reinterpret_cast<const char*>(data + pos), length);
+    pos += length;
+    return result;
+}
+
+NbtNode readPayload(const uint8_t* data, size_t size, size_t& pos, TagType type, int depth) {
+    if (depth > kMaxDepth) {
+        throw std::runtime_error("NBT: Nesting too deep");
+    }
+
+    NbtNode node;
+    node.type = type;
+
+    switch (type) {
+    case TagType::End:
+        break;
+    case TagType::Byte:
+        node.intValue = static_cast<int8_t>(readBigEndian(data, size, pos, 1));
+        break;
+    case TagType::Short:
+        node.intValue = static_cast<int16_t>(readBigEndian(data, size, pos, 2));
+        break;
+    case TagType::Int:
+        node.intValue = static_cast<int32_t>(readBigEndian(data, size, pos, 4));
+        break;
+    case TagType::Long:
+        node.intValue = static_cast<int64_t>(readBigEndian(data, size, pos, 8));
+        break;
+    case TagType::Float: {
+        auto bits = static_cast<uint32_t>(readBigEndian(data, size, pos, 4));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        node.floatValue = value;
+        break;
+    }
+    case TagType::Double: {
+        uint64_t bits = readBigEndian(data, size, pos, 8);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        node.floatValue = value;
+        break;
+    }
+    case TagType::ByteArray:
+    case TagType::IntArray:
+    case TagType::LongArray: {
+        int width = type == TagType::ByteArray ? 1 : (type == TagType::IntArray ? 4 : 8);
+        int32_t length = readLength(data, size, pos);
+        require(size, pos, static_cast<size_t>(length) * width);
+        node.arrayValue.reserve(length);
+        for (int32_t i = 0; i < length; i++) {
+            uint64_t raw = readBigEndian(data, size, pos, width);
+            if (width == 1) {
+                node.arrayValue.push_back(static_cast<int8_t>(raw));
+            } else if (width == 4) {
+                node.arrayValue.push_back(static_cast<int32_t>(raw));
+            } else {
+                node.arrayValue.push_back(static_cast<int64_t>(raw));
+            }
+        }
+        break;
+    }
+    case TagType::String:
+        node.stringValue = readStringPayload(data, size, pos);
+        break;
+    case TagType::List: {
+        require(size, pos, 1);
+        node.listType = static_cast<TagType>(data[pos++]);
+        int32_t count = readLength(data, size, pos);
+        for (int32_t i = 0; i < count; i++) {
+            node.list.push_back(readPayload(data, size, pos, node.listType, depth + 1));
+        }
+        break;
+    }
+    case TagType::Compound:
+        while (true) {
+            require(size, pos, 1);
+            auto childType = static_cast<TagType>(data[pos++]);
+            if (childType == TagType::End) {
+                break;
+            }
+            std::string name = readStringPayload(data, size, pos);
+            node.compound.emplace_back(std::move(name), readPayload(data, size, pos, childType, depth + 1));
+        }
+        break;
+    default:
+        throw std::runtime_error("NBT: Unknown tag type");
+    }
+
+    return node;
+}
+
+void writeLittleEndian(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void writeString(std::string& out, const std::string& value) {
+    writeLittleEndian(out, value.size(), 2);
+    out.append(value);
+}
+
+void writePayload(std::string& out, const NbtNode& node) {
+    switch (node.type) {
+    case TagType::End:
+        break;
+    case TagType::Byte:
+        writeLittleEndian(out, static_cast<uint64_t>(node.intValue), 1);
+        break;
+    case TagType::Short:
+        writeLittleEndian(out, static_cast<uint64_t>(node.intValue), 2);
+        break;
+    case TagType::Int:
+        writeLittleEndian(out, static_cast<uint64_t>(node.intValue), 4);
+        break;
+    case TagType::Long:
+        writeLittleEndian(out, static_cast<uint64_t>(node.intValue), 8);
+        break;
+    case TagType::Float: {
+        auto value = static_cast<float>(node.floatValue);
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeLittleEndian(out, bits, 4);
+        break;
+    }
+    case TagType::Double: {
+        uint64_t bits;
+        std::memcpy(&bits, &node.floatValue, sizeof(bits));
+        writeLittleEndian(out, bits, 8);
+        break;
+    }
+    case TagType::ByteArray:
+    case TagType::IntArray:
+    case TagType::LongArray: {
+        int width = node.type == TagType::ByteArray ? 1 : (node.type == TagType::IntArray ? 4 : 8);
+        writeLittleEndian(out, node.arrayValue.size(), 4);
+        for (int64_t value : node.arrayValue) {
+            writeLittleEndian(out, static_cast<uint64_t>(value), width);
+        }
+        break;
+    }
+    case TagType::String:
+        writeString(out, node.stringValue);
+        break;
+    case TagType::List:
+        out.push_back(static_cast<char>(node.list.empty() ? TagType::End : node.listType));
+        writeLittleEndian(out, node.list.size(), 4);
+        for (const auto& element : node.list) {
+            writePayload(out, element);
+        }
+        break;
+    case TagType::Compound:
+        for (const auto& [name, child] : node.compound) {
+            out.push_back(static_cast<char>(child.type));
+            writeString(out, name);
+            writePayload(out, child);
+        }
+        out.push_back(static_cast<char>(TagType::End));
+        break;
+    }
+}
+
+} // namespace
+
+void skipNbtPayload(const uint8_t* data, size_t size, size_t& pos, TagType type) {
+    skipPayload(data, size, pos, type, 0);
+}
+
+NbtNode readNbtPayload(const uint8_t* data, size_t size, size_t& pos, TagType type) {
+    return readPayload(data, size, pos, type, 0);
+}
+
+std::string writeBedrockNbt(const NbtNode& root) {
+    std::string out;
+    out.push_back(static_cast<char>(TagType::Compound));
+    writeString(out, "");
+    writePayload(out, root);
+    return out;
+}
+
+} // namespace wooden_axe
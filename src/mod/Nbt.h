@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wooden_axe {
+
+// NBT tag types
+enum class TagType : uint8_t {
+    End = 0,
+    Byte = 1,
+    Short = 2,
+    Int = 3,
+    Long = 4,
+    Float = 5,
+    Double = 6,
+    ByteArray = 7,
+    String = 8,
+    List = 9,
+    Compound = 10,
+    IntArray = 11,
+    LongArray = 12
+};
+
+// Small owning NBT tree, only used for payloads parsed on demand (block entities)
+struct NbtNode {
+    TagType type = TagType::End;
+    int64_t intValue = 0;            // Byte, Short, Int, Long
+    double floatValue = 0.0;         // Float, Double
+    std::string stringValue;         // String
+    std::vector<int64_t> arrayValue; // ByteArray, IntArray, LongArray
+    TagType listType = TagType::End;
+    std::vector<NbtNode> list;
+    std::vector<std::pair<std::string, NbtNode>> compound;
+
+    const NbtNode* find(std::string_view key) const {
+        for (const auto& [name, value] : compound) {
+            if (name == key) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+
+    void set(std::string key, NbtNode value) {
+        for (auto& [name, existing] : compound) {
+            if (name == key) {
+                existing = std::move(value);
+                return;
+            }
+        }
+        compound.emplace_back(std::move(key), std::move(value));
+    }
+
+    static NbtNode makeInt(TagType type, int64_t value) {
+        NbtNode node;
+        node.type = type;
+        node.intValue = value;
+        return node;
+    }
+
+    static NbtNode makeString(std::string value) {
+        NbtNode node;
+        node.type = TagType::String;
+        node.stringValue = std::move(value);
+        return node;
+    }
+
+    static NbtNode makeCompound() {
+        NbtNode node;
+        node.type = TagType::Compound;
+        return node;
+    }
+
+    static NbtNode makeList(TagType elementType) {
+        NbtNode node;
+        node.type = TagType::List;
+        node.listType = elementType;
+        return node;
+    }
+};
+
+// Skip one big-endian (Java) payload of the given type without allocating; throws on truncated data
+void skipNbtPayload(const uint8_t* data, size_t size, size_t& pos, TagType type);
+
+// Read one big-endian (Java) payload of the given type into a tree; throws on malformed data
+NbtNode readNbtPayload(const uint8_t* data, size_t size, size_t& pos, TagType type);
+
+// Serialize a compound as a little-endian (Bedrock) root tag with an empty name
+std::string writeBedrockNbt(const NbtNode& root);
+
+} // namespace wooden_axe
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "mod/Nbt.h"
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace wooden_axe {
+
+// FNV-1a over a field name; usable as a case label
+constexpr uint32_t nbtNameHash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// Field name as seen by a handler: a view into the buffer plus its precomputed hash.
+// Switch on `hash`, then confirm with `==` (hashes can collide on unknown names).
+struct NbtName {
+    std::string_view text;
+    uint32_t hash = 0;
+
+    bool operator==(std::string_view other) const { return text == other; }
+};
+
+// What the visitor should do with a compound or list
+enum class NbtAction : uint8_t {
+    Skip,   // Jump over the payload
+    Enter,  // Report children through the handler
+    Capture // Jump over it and hand the raw payload to onCapturedCompound / onCapturedList
+};
+
+// Big-endian numeric array read in place
+template <class T>
+class NbtArrayView {
+public:
+    NbtArrayView(const uint8_t* data, size_t count) : mData(data), mCount(count) {}
+
+    size_t size() const { return mCount; }
+
+    T operator[](size_t index) const {
+        using Unsigned = std::make_unsigned_t<T>;
+        Unsigned value = 0;
+        const uint8_t* p = mData + index * sizeof(T);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value = static_cast<Unsigned>((value << 8) | p[i]);
+        }
+        return static_cast<T>(value);
+    }
+
+private:
+    const uint8_t* mData;
+    size_t mCount;
+};
+
+// Callbacks a handler may provide. Every one is optional: payloads without a
+// matching callback are skipped and the dispatch for them is compiled out.
+namespace nbt_handler {
+
+template <class H>
+concept OnByte = requires(H& h, const NbtName& n, int8_t v) { h.onByte(n, v); };
+template <class H>
+concept OnShort = requires(H& h, const NbtName& n, int16_t v) { h.onShort(n, v); };
+template <class H>
+concept OnInt = requires(H& h, const NbtName& n, int32_t v) { h.onInt(n, v); };
+template <class H>
+concept OnLong = requires(H& h, const NbtName& n, int64_t v) { h.onLong(n, v); };
+template <class H>
+concept OnFloat = requires(H& h, const NbtName& n, float v) { h.onFloat(n, v); };
+template <class H>
+concept OnDouble = requires(H& h, const NbtName& n, double v) { h.onDouble(n, v); };
+template <class H>
+concept OnString = requires(H& h, const NbtName& n, std::string_view v) { h.onString(n, v); };
+template <class H>
+concept OnByteArray = requires(H& h, const NbtName& n, std::span<const uint8_t> v) { h.onByteArray(n, v); };
+template <class H>
+concept OnIntArray = requires(H& h, const NbtName& n, NbtArrayView<int32_t> v) { h.onIntArray(n, v); };
+template <class H>
+concept OnLongArray = requires(H& h, const NbtName& n, NbtArrayView<int64_t> v) { h.onLongArray(n, v); };
+template <class H>
+concept BeginCompound = requires(H& h, const NbtName& n) {
+    { h.beginCompound(n) } -> std::same_as<NbtAction>;
+};
+template <class H>
+concept EndCompound = requires(H& h) { h.endCompound(); };
+template <class H>
+concept BeginList = requires(H& h, const NbtName& n, TagType t, int32_t c) {
+    { h.beginList(n, t, c) } -> std::same_as<NbtAction>;
+};
+template <class H>
+concept EndList = requires(H& h) { h.endList(); };
+template <class H>
+concept OnCapturedCompound = requires(H& h, const NbtName& n, std::span<const uint8_t> p) {
+    h.onCapturedCompound(n, p);
+};
+template <class H>
+concept OnCapturedList = requires(H& h, const NbtName& n, TagType t, int32_t c, std::span<const uint8_t> p) {
+    h.onCapturedList(n, t, c, p);
+};
+
+} // namespace nbt_handler
+
+// Streaming walk over big-endian (Java) NBT. Nothing is materialized: names are
+// views into the buffer and every value goes straight to the handler.
+// Throws std::runtime_error on truncated or malformed data.
+template <class Handler>
+class NbtVisitor {
+public:
+    NbtVisitor(const uint8_t* data, size_t size, Handler& handler) : mData(data), mSize(size), mHandler(handler) {}
+
+    // Walk a root tag (type, name, payload). Children of the root compound are
+    // reported directly; the root itself gets no begin/end. False if it is not a compound.
+    bool visitRoot() {
+        if (readU8() != static_cast<uint8_t>(TagType::Compound)) {
+            return false;
+        }
+        readName();
+        visitCompoundPayload(0);
+        return true;
+    }
+
+    // Walk a compound payload captured earlier (children up to its End tag), reported like the root's
+    void visitCompoundBody() { visitCompoundPayload(0); }
+
+    size_t getPosition() const { return mPos; }
+
+private:
+    static constexpr int kMaxDepth = 512;
+
+    void require(size_t count) const {
+        if (count > mSize || mPos > mSize - count) {
+            throw std::runtime_error("NBT: Unexpected end of data");
+        }
+    }
+
+    uint8_t readU8() {
+        require(1);
+        return mData[mPos++];
+    }
+
+    template <class T>
+    T readBig() {
+        require(sizeof(T));
+        using Unsigned = std::make_unsigned_t<T>;
+        Unsigned value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value = static_cast<Unsigned>((value << 8) | mData[mPos + i]);
+        }
+        mPos += sizeof(T);
+        return static_cast<T>(value);
+    }
+
+    int32_t readLength() {
+        auto length = readBig<int32_t>();
+        if (length < 0) {
+            throw std::runtime_error("NBT: Negative length");
+        }
+        return length;
+    }
+
+    std::string_view readStringView() {
+        size_t length = readBig<uint16_t>();
+        require(length);
+        std::string_view result(reinterpret_cast<const char*>(mData + mPos), length);
+        mPos += length;
+        return result;
+    }
+
+    NbtName readName() {
+        auto text = readStringView();
+        return NbtName{text, nbtNameHash(text)};
+    }
+
+    // Advance over `count` elements of `width` bytes, returning where they start
+    const uint8_t* takeArray(size_t count, size_t width) {
+        require(count * width);
+        const uint8_t* start = mData + mPos;
+        mPos += count * width;
+        return start;
+    }
+
+    void skip(TagType type) { skipNbtPayload(mData, mSize, mPos, type); }
+
+    void visitCompoundPayload(int depth) {
+        if (depth > kMaxDepth) {
+            throw std::runtime_error("NBT: Nesting too deep");
+        }
+        while (true) {
+            auto type = static_cast<TagType>(readU8());
+            if (type == TagType::End) {
+                break;
+            }
+            NbtName name = readName();
+            visitValue(type, name, depth);
+        }
+    }
+
+    void visitValue(TagType type, const NbtName& name, int depth) {
+        using namespace nbt_handler;
+
+        switch (type) {
+        case TagType::Byte:
+            if constexpr (OnByte<Handler>) {
+                mHandler.onByte(name, static_cast<int8_t>(readU8()));
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::Short:
+            if constexpr (OnShort<Handler>) {
+                mHandler.onShort(name, readBig<int16_t>());
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::Int:
+            if constexpr (OnInt<Handler>) {
+                mHandler.onInt(name, readBig<int32_t>());
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::Long:
+            if constexpr (OnLong<Handler>) {
+                mHandler.onLong(name, readBig<int64_t>());
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::Float:
+            if constexpr (OnFloat<Handler>) {
+                mHandler.onFloat(name, std::bit_cast<float>(readBig<uint32_t>()));
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::Double:
+            if constexpr (OnDouble<Handler>) {
+                mHandler.onDouble(name, std::bit_cast<double>(readBig<uint64_t>()));
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::String:
+            if constexpr (OnString<Handler>) {
+                mHandler.onString(name, readStringView());
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::ByteArray:
+            if constexpr (OnByteArray<Handler>) {
+                size_t count = readLength();
+                mHandler.onByteArray(name, std::span<const uint8_t>(takeArray(count, 1), count));
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::IntArray:
+            if constexpr (OnIntArray<Handler>) {
+                size_t count = readLength();
+                mHandler.onIntArray(name, NbtArrayView<int32_t>(takeArray(count, 4), count));
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::LongArray:
+            if constexpr (OnLongArray<Handler>) {
+                size_t count = readLength();
+                mHandler.onLongArray(name, NbtArrayView<int64_t>(takeArray(count, 8), count));
+            } else {
+                skip(type);
+            }
+            break;
+        case TagType::Compound:
+            visitCompound(name, depth);
+            break;
+        case TagType::List:
+            visitList(name, depth);
+            break;
+        default:
+            throw std::runtime_error("NBT: Unknown tag type");
+        }
+    }
+
+    void visitCompound(const NbtName& name, int depth) {
+        using namespace nbt_handler;
+
+        if constexpr (BeginCompound<Handler>) {
+            size_t start = mPos;
+            switch (mHandler.beginCompound(name)) {
+            case NbtAction::Enter:
+                visitCompoundPayload(depth + 1);
+                if constexpr (EndCompound<Handler>) {
+                    mHandler.endCompound();
+                }
+                return;
+            case NbtAction::Capture:
+                skip(TagType::Compound);
+                if constexpr (OnCapturedCompound<Handler>) {
+                    mHandler.onCapturedCompound(name, std::span<const uint8_t>(mData + start, mPos - start));
+                }
+                return;
+            case NbtAction::Skip:
+                break;
+            }
+        }
+        skip(TagType::Compound);
+    }
+
+    void visitList(const NbtName& name, int depth) {
+        using namespace nbt_handler;
+
+        if constexpr (BeginList<Handler>) {
+            size_t header = mPos;
+            auto elementType = static_cast<TagType>(readU8());
+            int32_t count = readLength();
+            size_t start = mPos;
+
+            switch (mHandler.beginList(name, elementType, count)) {
+            case NbtAction::Enter: {
+                // Elements carry no name of their own
+                NbtName element{std::string_view(), nbtNameHash("")};
+                for (int32_t i = 0; i < count; i++) {
+                    visitValue(elementType, element, depth + 1);
+                }
+                if constexpr (EndList<Handler>) {
+                    mHandler.endList();
+                }
+                return;
+            }
+            case NbtAction::Capture:
+                for (int32_t i = 0; i < count; i++) {
+                    skip(elementType);
+                }
+                if constexpr (OnCapturedList<Handler>) {
+                    mHandler.onCapturedList(
+                        name, elementType, count, std::span<const uint8_t>(mData + start, mPos - start)
+                    );
+                }
+                return;
+            case NbtAction::Skip:
+                mPos = header;
+                break;
+            }
+        }
+        skip(TagType::List);
+    }
+
+    const uint8_t* mData;
+    size_t mSize;
+    size_t mPos = 0;
+    Handler& mHandler;
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace wooden_axe {
+
+// Allocation counters for one schematic load
+struct ParseStats {
+    size_t arenaAllocations = 0; // Temporaries served by the arena
+    size_t arenaBytes = 0;
+    size_t upstreamBlocks = 0;   // Blocks the arena took from the global heap
+    size_t upstreamBytes = 0;
+    double parseMs = 0.0;
+};
+
+// Forwards to another resource and counts what passes through
+class CountingResource : public std::pmr::memory_resource {
+public:
+    CountingResource(std::pmr::memory_resource* upstream, size_t& count, size_t& bytes)
+    : mUpstream(upstream),
+      mCount(count),
+      mBytes(bytes) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        mCount++;
+        mBytes += bytes;
+        return mUpstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override { mUpstream->deallocate(p, bytes, alignment); }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource* mUpstream;
+    size_t& mCount;
+    size_t& mBytes;
+};
+
+// Per-load monotonic arena for parser temporaries (palette map nodes, packed
+// arrays, remap tables). Nothing is freed individually; everything goes at once
+// when the arena is destroyed. Single-threaded, like the parser that owns it.
+class ParseArena {
+public:
+    explicit ParseArena(size_t initialSize = 64 * 1024)
+    : mHeap(std::pmr::new_delete_resource(), mStats.upstreamBlocks, mStats.upstreamBytes),
+      mMonotonic(initialSize, &mHeap),
+      mCounted(&mMonotonic, mStats.arenaAllocations, mStats.arenaBytes) {}
+
+    ParseArena(const ParseArena&) = delete;
+    ParseArena& operator=(const ParseArena&) = delete;
+
+    std::pmr::memory_resource* get() { return &mCounted; }
+
+    ParseStats& getStats() { return mStats; }
+
+private:
+    ParseStats mStats;
+    CountingResource mHeap;
+    std::pmr::monotonic_buffer_resource mMonotonic;
+    CountingResource mCounted;
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,342 @@
+#include "mod/PasteJob.h"
+#include "mod/BlockEntities.h"
+#include "mod/Log.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace wooden_axe {
+
+PasteOptions makePasteOptions(const Config& config) {
+    PasteOptions options;
+    options.coalesceUpdates = config.coalesceClientUpdates;
+    options.chunkLoadTimeout = std::chrono::seconds(config.chunkLoadTimeoutSeconds);
+    options.preloadChunks = config.preloadChunks;
+    options.bulkSectionWrites = config.bulkSectionWrites;
+    return options;
+}
+
+void PasteJob::setPlanSource(size_t planCount, std::function<void()> requestNext) {
+    mPlanCount = std::max<size_t>(planCount, 1);
+    mRequestNext = std::move(requestNext);
+}
+
+void PasteJob::addPlan(std::shared_ptr<const PlacementPlan> plan, bool last, int chunkOffsetX, int chunkOffsetZ) {
+    mLastPlanQueued = last;
+    if (!mPlan || isPlanDrained()) {
+        activatePlan(std::move(plan), chunkOffsetX, chunkOffsetZ);
+    } else {
+        mPendingPlan = std::move(plan);
+        mPendingOffsetX = chunkOffsetX;
+        mPendingOffsetZ = chunkOffsetZ;
+    }
+}
+
+void PasteJob::failPlans(const std::string& reason) {
+    Log::error("Paste job {} stopped: {}", getId(), reason);
+    mLastPlanQueued = true;
+    mPlanFailed = true;
+    mPendingPlan.reset();
+    mRequestNext = nullptr;
+}
+
+void PasteJob::activatePlan(std::shared_ptr<const PlacementPlan> plan, int chunkOffsetX, int chunkOffsetZ) {
+    mPlan = std::move(plan);
+    mChunkOffsetX = chunkOffsetX;
+    mChunkOffsetZ = chunkOffsetZ;
+    mPlansStarted++;
+    mResult.skipped += mPlan->skipped;
+    mResult.failed += mPlan->failed;
+    mTotalWork += mPlan->getCommandCount();
+    mNextRequest = 0;
+    mActiveChunk = kNoChunk;
+    
+    // Bucket block entities by chunk so each is loaded right after its chunk's blocks (plan coordinates)
+    std::unordered_map<uint64_t, size_t> chunkIndex;
+    for (size_t i = 0; i < mPlan->chunks.size(); i++) {
+        const auto& chunk = mPlan->chunks[i];
+        chunkIndex.emplace((static_cast<uint64_t>(static_cast<uint32_t>(chunk.chunkX)) << 32)
+                           | static_cast<uint32_t>(chunk.chunkZ), i);
+    }
+    mChunkEntities.assign(mPlan->chunks.size(), {});
+    for (size_t i = 0; i < mPlan->blockEntities.size(); i++) {
+        const auto& entity = mPlan->blockEntities[i];
+        auto it = chunkIndex.find((static_cast<uint64_t>(static_cast<uint32_t>(entity.x >> 4)) << 32)
+                                  | static_cast<uint32_t>(entity.z >> 4));
+        if (it != chunkIndex.end()) {
+            mChunkEntities[it->second].push_back(static_cast<uint32_t>(i));
+            mTotalWork++;
+        }
+    }
+    
+    // Decode the next window while this one is written
+    if (!mLastPlanQueued && mRequestNext) {
+        mRequestNext();
+    }
+    
+    fillWindow();
+}
+
+bool PasteJob::fillWindow() {
+    while (mWindow.size() < mPreloadChunks && mNextRequest < mPlan->chunks.size()) {
+        const auto& chunk = mPlan->chunks[mNextRequest];
+        if (!mPreloader.request(chunk.chunkX + mChunkOffsetX, chunk.chunkZ + mChunkOffsetZ)) {
+            return false;
+        }
+        mWindow.push_back(mNextRequest++);
+    }
+    return true;
+}
+
+size_t PasteJob::takeReadyChunk() {
+    for (size_t k = 0; k < mWindow.size();) {
+        size_t index = mWindow[k];
+        const auto& chunk = mPlan->chunks[index];
+        int chunkX = chunk.chunkX + mChunkOffsetX;
+        int chunkZ = chunk.chunkZ + mChunkOffsetZ;
+        switch (mPreloader.poll(chunkX, chunkZ)) {
+        case ChunkLoadState::Loading:
+            k++;
+            break;
+        case ChunkLoadState::Ready:
+            mWindow.erase(mWindow.begin() + k);
+            return index;
+        case ChunkLoadState::TimedOut: {
+            Log::warn("Chunk ({}, {}) did not load in time, skipping it", chunkX, chunkZ);
+            size_t lost = chunk.commands.size() + mChunkEntities[index].size();
+            mResult.failed += chunk.commands.size();
+            mDoneWork += lost;
+            mPreloader.release(chunkX, chunkZ);
+            mWindow.erase(mWindow.begin() + k);
+            break;
+        }
+        }
+    }
+    return kNoChunk;
+}
+
+void PasteJob::endChunk() {
+    if (mChunkOpen) {
+        WA_TRACE_ZONE("refresh subchunks");
+        mResult.refreshedSubchunks += mSink->endChunk();
+        mChunkOpen = false;
+    }
+}
+
+void PasteJob::finish(bool ok) {
+    mResult.ok = ok;
+    mDone = true;
+    endChunk();
+    mWindow.clear();
+    mPreloader.clear();
+    mRequestNext = nullptr;
+    Tracer::getInstance().endCapture(std::exchange(mTraceCapture, 0));
+}
+
+size_t PasteJob::runSlice(size_t budget) {
+    if (mDone) {
+        return 0;
+    }
+    if (!mPlan) {
+        if (mLastPlanQueued) {
+            finish(!mPlanFailed); // Producer failed before the first plan
+        }
+        return 0; // Still planning
+    }
+    
+    WA_TRACE_ZONE("paste slice");
+    
+    // A world-side mask decides per block, so whole sections cannot be written blind.
+    // Section writes send no per-block packets: they reach clients only through coalescing.
+    bool checkWorld = mMask.checksWorld();
+    bool bulkSections = mBulkSectionWrites && mCoalesceUpdates && !checkWorld
+                     && budget >= ChunkCommandBuffer::kSectionVolume;
+    size_t used = 0;
+    
+    while (used < budget) {
+        if (isPlanDrained()) {
+            if (!mPendingPlan) {
+                break; // Done, or the next window is still being decoded
+            }
+            activatePlan(std::move(mPendingPlan), mPendingOffsetX, mPendingOffsetZ);
+        }
+        
+        bool worldAvailable;
+        {
+            WA_TRACE_ZONE("request chunks");
+            worldAvailable = fillWindow();
+        }
+        if (!worldAvailable) {
+            Log::error("World of paste job {} is no longer available", getId());
+            finish(false);
+            break;
+        }
+        
+        if (mActiveChunk == kNoChunk) {
+            mActiveChunk = takeReadyChunk();
+            mCommandIndex = 0;
+            mEntityIndex = 0;
+            mKeptInChunk.clear();
+            if (mActiveChunk == kNoChunk) {
+                break; // Nothing loaded yet, try again next tick
+            }
+        }
+        
+        const auto& plan = *mPlan;
+        const auto& chunk = plan.chunks[mActiveChunk];
+        int chunkX = chunk.chunkX + mChunkOffsetX;
+        int chunkZ = chunk.chunkZ + mChunkOffsetZ;
+        int chunkBaseX = chunkX * 16;
+        int chunkBaseZ = chunkZ * 16;
+        
+        if (!mChunkOpen && mCommandIndex < chunk.commands.size()) {
+            if (!mSink->beginChunk(chunkX, chunkZ)) {
+                Log::error("World of paste job {} is no longer available", getId());
+                finish(false);
+                break;
+            }
+            mChunkOpen = true;
+        }
+        bool sliceFull = false;
+        
+        {
+            WA_TRACE_ZONE("setBlock");
+            while (used < budget && mCommandIndex < chunk.commands.size()) {
+                if (bulkSections && chunk.isFullSectionAt(mCommandIndex)) {
+                    if (budget - used < ChunkCommandBuffer::kSectionVolume) {
+                        sliceFull = true; // Sections are never split across slices
+                        break;
+                    }
+                    size_t written = mSink->writeSection(chunkX, chunkZ, &chunk.commands[mCommandIndex], plan.blocks);
+                    mResult.placed += written;
+                    mResult.failed += ChunkCommandBuffer::kSectionVolume - written;
+                    mResult.suppressedUpdates += written;
+                    mCommandIndex += ChunkCommandBuffer::kSectionVolume;
+                    used += ChunkCommandBuffer::kSectionVolume;
+                    continue;
+                }
+                
+                const auto& command = chunk.commands[mCommandIndex++];
+                used++;
+                
+                int x = chunkBaseX + command.localX();
+                int z = chunkBaseZ + command.localZ();
+                if (checkWorld && !mMask.allowsOverwrite(*mSink->getBlock(x, command.worldY(), z), *mSink)) {
+                    mResult.kept++;
+                    // Its block entity must not load into the block that stayed
+                    if (!mChunkEntities[mActiveChunk].empty()) {
+                        mKeptInChunk.insert(command.packedPos);
+                    }
+                    continue;
+                }
+                try {
+                    if (!mSink->setBlock(x, command.worldY(), z, *plan.blocks[command.blockIndex], !mCoalesceUpdates)) {
+                        mResult.failed++;
+                        continue;
+                    }
+                    mResult.placed++;
+                    if (mCoalesceUpdates) {
+                        mResult.suppressedUpdates++;
+                    }
+                } catch (const std::exception& e) {
+                    Log::debug("Failed to place block at ({}, {}, {}): {}", x, command.worldY(), z, e.what());
+                    mResult.failed++;
+                }
+            }
+        }
+        if (sliceFull) {
+            break;
+        }
+        
+        // Clients see the chunk's blocks before any block actor data that refers to them
+        if (mCommandIndex >= chunk.commands.size()) {
+            endChunk();
+        }
+        
+        // Block actors exist only after their blocks are written
+        const auto& entities = mChunkEntities[mActiveChunk];
+        {
+            WA_TRACE_ZONE("block entities");
+            while (used < budget && mCommandIndex >= chunk.commands.size() && mEntityIndex < entities.size()) {
+                const auto& entity = plan.blockEntities[entities[mEntityIndex++]];
+                used++;
+                auto packedPos = BlockCommand::pack(entity.x & 15, entity.y, entity.z & 15);
+                if (!mKeptInChunk.empty() && mKeptInChunk.count(packedPos)) {
+                    continue;
+                }
+                int x = entity.x + mChunkOffsetX * 16;
+                int z = entity.z + mChunkOffsetZ * 16;
+                bool loaded;
+                if (mChunkOffsetX == 0 && mChunkOffsetZ == 0) {
+                    loaded = mSink->loadBlockEntity(x, entity.y, z, entity.nbt);
+                } else {
+                    // A shifted copy: the tag still names the plan position, which the actor would take
+                    std::string nbt = entity.nbt;
+                    setBedrockBlockEntityPosition(nbt, x, entity.y, z);
+                    loaded = mSink->loadBlockEntity(x, entity.y, z, nbt);
+                }
+                if (loaded) {
+                    mResult.blockEntities++;
+                }
+            }
+        }
+        
+        if (mCommandIndex >= chunk.commands.size() && mEntityIndex >= entities.size()) {
+            mPreloader.release(chunkX, chunkZ);
+            mKeptInChunk.clear();
+            mActiveChunk = kNoChunk;
+        }
+    }
+    
+    mDoneWork += used;
+    
+    if (!mDone && isPlanDrained() && !mPendingPlan && mLastPlanQueued) {
+        finish(!mPlanFailed);
+    }
+    return used;
+}
+
+void PasteJob::onFinished() {
+    Log::info(
+        "Schematic placement complete: {} placed, {} skipped (air or filtered), {} kept by mask, {} failed, "
+        "{} block entities, {} block updates coalesced into {} subchunk refreshes",
+        mResult.placed, mResult.skipped, mResult.kept, mResult.failed, mResult.blockEntities,
+        mResult.suppressedUpdates, mResult.refreshedSubchunks
+    );
+    if (mOnComplete) {
+        mOnComplete(mResult);
+    }
+}
+
+void PasteJob::onCancelled() {
+    Log::info("Paste job {} cancelled after {} blocks", getId(), mResult.placed);
+    
+    // Blocks already written without client updates still have to reach clients
+    endChunk();
+    mWindow.clear();
+    mPreloader.clear();
+    mPlan.reset();
+    mPendingPlan.reset();
+    mRequestNext = nullptr;
+    Tracer::getInstance().endCapture(std::exchange(mTraceCapture, 0));
+}
+
+std::string PasteJob::describe() const {
+    if (!mPlan) {
+        return mDescription + " (planning)";
+    }
+    std::string text = mDescription;
+    if (mPlanCount > 1) {
+        text += " [window " + std::to_string(mPlansStarted) + "/" + std::to_string(mPlanCount) + "]";
+    }
+    if (isPlanDrained() && !mLastPlanQueued) {
+        return text + " (decoding)";
+    }
+    if (mActiveChunk == kNoChunk && !mWindow.empty()) {
+        return text + " (loading " + std::to_string(mWindow.size()) + " chunks)";
+    }
+    return text;
+}
+
+} // namespace wooden_axe
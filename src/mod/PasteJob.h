@@ -0,0 +1,152 @@
+#pragma once
+
+#include "mod/BlockBox.h"
+#include "mod/ChunkPreloader.h"
+#include "mod/Config.h"
+#include "mod/JobScheduler.h"
+#include "mod/PasteMask.h"
+#include "mod/PlacementPlan.h"
+#include "mod/Trace.h"
+#include "mod/WorldSink.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace wooden_axe {
+
+// Outcome of a finished paste
+struct PlaceResult {
+    bool ok = false;
+    size_t placed = 0;
+    size_t skipped = 0; // Air, or filtered out by the paste mask
+    size_t failed = 0;
+    size_t blockEntities = 0; // Block actors restored from schematic data
+    size_t kept = 0; // World blocks the paste mask did not let it overwrite
+    size_t suppressedUpdates = 0; // Blocks written without their own client update packet
+    size_t refreshedSubchunks = 0; // Subchunks whose changes were announced together in their place
+};
+
+// How a paste is written
+struct PasteOptions {
+    JobPriority priority = JobPriority::Normal;
+    // Write blocks without per-block client updates and send each touched subchunk's
+    // changes in one packet once its chunk is done (Config::coalesceClientUpdates)
+    bool coalesceUpdates = false;
+    // Target chunks not loaded this long after their request are skipped as failed
+    std::chrono::seconds chunkLoadTimeout{30};
+    PasteMask mask;
+    // Only the part of the schematic inside this world box is visited and written
+    std::optional<BlockBox> clip;
+    // Chunks kept requested ahead of the one being written (Config::preloadChunks)
+    size_t preloadChunks = 16;
+    // Write fully covered sections in one call where nothing reads the world (Config::bulkSectionWrites)
+    bool bulkSectionWrites = false;
+};
+
+// Paste options as the config sets them; callers fill in priority, mask and clip
+PasteOptions makePasteOptions(const Config& config);
+
+// Drains a placement plan into a world sink in budgeted slices, on whichever thread ticks its
+// JobScheduler (the server thread in the plugin).
+// Queued as soon as the paste is requested; it idles until the worker stage hands over the plan.
+// Target chunks are loaded ahead of the writer and each chunk is written once it is ready.
+// A streamed paste hands over one plan per window; they are written in order.
+class PasteJob : public TickJob {
+public:
+    PasteJob(std::shared_ptr<WorldSink> sink, std::string description, const PasteOptions& options,
+             std::function<void(const PlaceResult&)> onComplete)
+    : mSink(std::move(sink)),
+      mCoalesceUpdates(options.coalesceUpdates),
+      mBulkSectionWrites(options.bulkSectionWrites),
+      mPreloadChunks(std::max<size_t>(1, options.preloadChunks)),
+      mMask(options.mask),
+      mDescription(std::move(description)),
+      mOnComplete(std::move(onComplete)),
+      mTraceCapture(Tracer::getInstance().beginCapture(mDescription)),
+      mPreloader(*mSink, options.chunkLoadTimeout) {}
+    
+    // Server thread, once a plan is built; `last` marks the final one.
+    // The plan is written shifted by whole chunks, so one plan can be queued for several copies.
+    void addPlan(std::shared_ptr<const PlacementPlan> plan, bool last, int chunkOffsetX = 0, int chunkOffsetZ = 0);
+    
+    // Server thread: the producer gave up, finish with what was written
+    void failPlans(const std::string& reason);
+    
+    // Streamed paste: called each time a plan starts being written and more are due,
+    // so the next window is decoded while this one is written
+    void setPlanSource(size_t planCount, std::function<void()> requestNext);
+    
+    size_t runSlice(size_t budget) override;
+    bool isFinished() const override { return mDone; }
+    void onFinished() override;
+    void onCancelled() override;
+    std::string describe() const override;
+    // Streamed pastes extrapolate from the windows seen so far
+    size_t getTotalWork() const override {
+        return mPlansStarted > 0 ? mTotalWork * mPlanCount / mPlansStarted : mTotalWork;
+    }
+    size_t getDoneWork() const override { return mDoneWork; }
+
+private:
+    static constexpr size_t kNoChunk = static_cast<size_t>(-1);
+    
+    void activatePlan(std::shared_ptr<const PlacementPlan> plan, int chunkOffsetX, int chunkOffsetZ);
+    
+    // Every chunk of the current plan written (or given up on)
+    bool isPlanDrained() const {
+        return mActiveChunk == kNoChunk && mWindow.empty() && mNextRequest >= mPlan->chunks.size();
+    }
+    
+    // Keep up to preloadChunks chunks requested ahead of the writer; false if the world is gone
+    bool fillWindow();
+    
+    // Pick the next loaded chunk from the window, or kNoChunk if none is ready yet
+    size_t takeReadyChunk();
+    
+    // Close the active chunk in the sink, sending its coalesced refreshes
+    void endChunk();
+    
+    void finish(bool ok);
+    
+    std::shared_ptr<WorldSink> mSink;
+    bool mCoalesceUpdates;
+    bool mBulkSectionWrites;
+    size_t mPreloadChunks;
+    PasteMask mMask;
+    std::string mDescription;
+    std::function<void(const PlaceResult&)> mOnComplete;
+    uint64_t mTraceCapture; // Open from creation until the job ends, 0 when not tracing
+    
+    std::shared_ptr<const PlacementPlan> mPlan;
+    std::shared_ptr<const PlacementPlan> mPendingPlan; // Next window, handed over early
+    int mChunkOffsetX = 0; // Shift of the current plan, in chunks
+    int mChunkOffsetZ = 0;
+    int mPendingOffsetX = 0;
+    int mPendingOffsetZ = 0;
+    bool mLastPlanQueued = false;
+    bool mPlanFailed = false;
+    size_t mPlanCount = 1;
+    size_t mPlansStarted = 0;
+    std::function<void()> mRequestNext;
+    
+    std::vector<std::vector<uint32_t>> mChunkEntities; // Block-entity indices per plan chunk
+    ChunkPreloader mPreloader;
+    std::vector<size_t> mWindow; // Requested, not yet written, in plan order
+    size_t mNextRequest = 0;
+    size_t mActiveChunk = kNoChunk;
+    size_t mCommandIndex = 0;
+    size_t mEntityIndex = 0;
+    bool mChunkOpen = false; // Active chunk begun in the sink
+    std::unordered_set<uint32_t> mKeptInChunk; // Packed positions of the active chunk the mask kept
+    size_t mTotalWork = 0;
+    size_t mDoneWork = 0;
+    bool mDone = false;
+    PlaceResult mResult;
+};
+
+} // namespace wooden_axe
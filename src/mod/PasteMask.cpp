@@ -0,0 +1,41 @@
+#include "mod/PasteMask.h"
+#include "mod/WorldSink.h"
+
+namespace wooden_axe {
+
+// Block ids are dense; anything past this is classified on every call instead of growing the table
+constexpr size_t kMaxVerdicts = 1 << 20;
+
+size_t PasteMask::applySourceFilter(ResolvedPalette& palette, const WorldSink& sink) const {
+    if (only.empty()) {
+        return 0;
+    }
+    size_t dropped = 0;
+    for (size_t i = 0; i < palette.kinds.size(); i++) {
+        if (palette.kinds[i] == PaletteEntryKind::Place
+            && !only.containsType(sink.getBlockTypeName(*palette.blocks[i]))) {
+            palette.kinds[i] = PaletteEntryKind::Air;
+            dropped++;
+        }
+    }
+    return dropped;
+}
+
+bool PasteMask::allowsOverwrite(const Block& existing, const WorldSink& sink) {
+    size_t id = sink.getBlockId(existing);
+    if (id < mVerdicts.size() && mVerdicts[id] != Unknown) {
+        return mVerdicts[id] == Overwrite;
+    }
+
+    std::string type = sink.getBlockTypeName(existing);
+    bool allowed = (!onlyIntoAir || type == "minecraft:air") && (keep.empty() || !keep.containsType(type));
+    if (id < kMaxVerdicts) {
+        if (id >= mVerdicts.size()) {
+            mVerdicts.resize(id + 1, Unknown);
+        }
+        mVerdicts[id] = allowed ? Overwrite : Keep;
+    }
+    return allowed;
+}
+
+} // namespace wooden_axe
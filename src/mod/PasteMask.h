@@ -0,0 +1,50 @@
+#pragma once
+
+#include "mod/BlockMatchSet.h"
+#include "mod/PlacementPlan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Block;
+
+namespace wooden_axe {
+
+class WorldSink;
+
+// Which blocks a paste writes and which world blocks it may overwrite.
+// The source filter is compiled into the resolved palette before planning, the world side
+// into a verdict table by block state, so no names are compared while writing.
+class PasteMask {
+public:
+    // Only write where the world has air
+    bool onlyIntoAir = false;
+    // World blocks of these types are never overwritten
+    BlockMatchSet keep;
+    // Only schematic blocks of these types are written (empty = all)
+    BlockMatchSet only;
+
+    // Whether writes have to look at the world block first
+    bool checksWorld() const { return onlyIntoAir || !keep.empty(); }
+
+    // Turn palette entries the source filter rejects into skipped entries, so the plan never
+    // contains them. `sink` is the one the palette was resolved against. Returns how many
+    // entries were dropped.
+    size_t applySourceFilter(ResolvedPalette& palette, const WorldSink& sink) const;
+
+    // Whether the world block at a write target, read from `sink`, may be replaced. Each block
+    // state is classified once; after that this is one table lookup.
+    bool allowsOverwrite(const Block& existing, const WorldSink& sink);
+
+private:
+    enum Verdict : uint8_t {
+        Unknown = 0,
+        Overwrite = 1,
+        Keep = 2
+    };
+
+    std::vector<uint8_t> mVerdicts; // By WorldSink::getBlockId
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,648 @@
+#include "mod/PlacementPlan.h"
+#include "mod/Trace.h"
+#include "mod/WorkerPool.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace wooden_axe {
+
+namespace {
+
+constexpr int kSection = SectionedBlocks::kSize;
+
+// The whole schematic, or its part inside a clip; empty if they do not overlap
+PlacementClip getPlacementBounds(const Schematic& schem, const PlacementClip* clip) {
+    PlacementClip bounds{0, 0, 0, schem.width, schem.height, schem.length};
+    if (clip) {
+        bounds.minX = std::max(bounds.minX, clip->minX);
+        bounds.minY = std::max(bounds.minY, clip->minY);
+        bounds.minZ = std::max(bounds.minZ, clip->minZ);
+        bounds.maxX = std::min(bounds.maxX, clip->maxX);
+        bounds.maxY = std::min(bounds.maxY, clip->maxY);
+        bounds.maxZ = std::min(bounds.maxZ, clip->maxZ);
+    }
+    return bounds;
+}
+
+bool isEmpty(const PlacementClip& bounds) {
+    return bounds.minX >= bounds.maxX || bounds.minY >= bounds.maxY || bounds.minZ >= bounds.maxZ;
+}
+
+size_t getVolume(const PlacementClip& bounds) {
+    if (isEmpty(bounds)) {
+        return 0;
+    }
+    return static_cast<size_t>(bounds.maxX - bounds.minX) * (bounds.maxY - bounds.minY) * (bounds.maxZ - bounds.minZ);
+}
+
+// Bounds narrowed to the schematic's non-air box; everything cut away is air
+PlacementClip getContentBounds(const Schematic& schem, const PlacementClip& bounds) {
+    const auto& occupancy = schem.occupancy;
+    if (!occupancy.known) {
+        return bounds;
+    }
+    PlacementClip content{
+        std::max(bounds.minX, occupancy.minX),
+        std::max(bounds.minY, occupancy.minY),
+        std::max(bounds.minZ, occupancy.minZ),
+        std::min(bounds.maxX, occupancy.maxX),
+        std::min(bounds.maxY, occupancy.maxY),
+        std::min(bounds.maxZ, occupancy.maxZ)
+    };
+    return isEmpty(content) ? PlacementClip{0, 0, 0, 0, 0, 0} : content;
+}
+
+// Where a schematic lands in the world: its origin and the chunk columns its placed part covers
+struct PlacementGrid {
+    PlacementGrid(const Schematic& schem, int baseX, int baseY, int baseZ, const PlacementClip& bounds)
+    : originX(baseX + schem.offsetX),
+      originY(baseY + schem.offsetY),
+      originZ(baseZ + schem.offsetZ) {
+        // Arithmetic shift floors negative coordinates correctly
+        minChunkX = (originX + bounds.minX) >> 4;
+        minChunkZ = (originZ + bounds.minZ) >> 4;
+        chunksX = ((originX + bounds.maxX - 1) >> 4) - minChunkX + 1;
+        chunksZ = ((originZ + bounds.maxZ - 1) >> 4) - minChunkZ + 1;
+    }
+
+    size_t getColumnIndex(int chunkX, int chunkZ) const {
+        return static_cast<size_t>(chunkZ - minChunkZ) * chunksX + (chunkX - minChunkX);
+    }
+
+    int originX, originY, originZ;
+    int minChunkX, minChunkZ;
+    int chunksX, chunksZ;
+};
+
+// One section column of the schematic (16 x height x 16), narrowed to the placed bounds.
+// Unless the paste is chunk-aligned it straddles up to 2x2 chunk columns, its "pieces"
+// (pieceZ * 2 + pieceX), counted from the chunk of the section's corner.
+struct SectionColumn {
+    SectionColumn(const Schematic& schem, const PlacementGrid& grid, size_t column, const PlacementClip& bounds) {
+        int sectionsX = schem.blocks.getSectionsX();
+        sectionX = static_cast<int>(column % sectionsX);
+        sectionZ = static_cast<int>(column / sectionsX);
+        beginX = std::max(sectionX * kSection, bounds.minX);
+        endX = std::min(sectionX * kSection + kSection, bounds.maxX);
+        beginZ = std::max(sectionZ * kSection, bounds.minZ);
+        endZ = std::min(sectionZ * kSection + kSection, bounds.maxZ);
+        skipX = beginX - sectionX * kSection;
+        skipZ = beginZ - sectionZ * kSection;
+        firstChunkX = (grid.originX + sectionX * kSection) >> 4;
+        firstChunkZ = (grid.originZ + sectionZ * kSection) >> 4;
+
+        for (int x = beginX; x < endX; x++) {
+            pieceX[x - beginX] = static_cast<uint8_t>(((grid.originX + x) >> 4) - firstChunkX);
+            localX[x - beginX] = static_cast<uint8_t>((grid.originX + x) & 0xF);
+        }
+        for (int z = beginZ; z < endZ; z++) {
+            pieceZ[z - beginZ] = static_cast<uint8_t>(((grid.originZ + z) >> 4) - firstChunkZ);
+            localZ[z - beginZ] = static_cast<uint8_t>((grid.originZ + z) & 0xF);
+        }
+    }
+
+    bool empty() const { return beginX >= endX || beginZ >= endZ; }
+
+    size_t getVoxelCount(int beginY, int endY) const {
+        return static_cast<size_t>(endX - beginX) * (endY - beginY) * (endZ - beginZ);
+    }
+
+    int sectionX, sectionZ;
+    int beginX, endX, beginZ, endZ;
+    int skipX, skipZ; // Offset of begin inside the section
+    int firstChunkX, firstChunkZ;
+    uint8_t pieceX[kSection], localX[kSection];
+    uint8_t pieceZ[kSection], localZ[kSection];
+};
+
+// Whether the occupancy proves a section column holds only air within its range
+bool isColumnEmpty(const Schematic& schem, const SectionColumn& range) {
+    const auto& occupancy = schem.occupancy;
+    if (!occupancy.known) {
+        return false;
+    }
+    for (int z = range.beginZ; z < range.endZ; z++) {
+        const auto* columns = &occupancy.columns[static_cast<size_t>(z) * schem.width];
+        for (int x = range.beginX; x < range.endX; x++) {
+            if (columns[x] > 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Whether the occupancy proves layers [beginY, endY) hold only air
+bool areLayersEmpty(const Schematic& schem, int beginY, int endY) {
+    const auto& occupancy = schem.occupancy;
+    if (!occupancy.known) {
+        return false;
+    }
+    for (int y = beginY; y < endY; y++) {
+        if (occupancy.layers[y] > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes of decoded sections, split into the pieces of their section column
+struct SectionCommands {
+    std::array<std::vector<BlockCommand>, 4> pieces;
+    size_t skipped = 0;
+    size_t failed = 0;
+};
+
+// Append the writes of `layers` layers of a decoded section from `firstLayer` on; firstLayer lands at worldY
+void compileSection(const int* values, const SectionColumn& range, int firstLayer, int layers, int worldY,
+                    const ResolvedPalette& palette, SectionCommands& out) {
+    size_t paletteSize = palette.kinds.size();
+    for (int ly = 0; ly < layers; ly++) {
+        for (int lz = 0; lz < range.endZ - range.beginZ; lz++) {
+            auto* row = &out.pieces[range.pieceZ[lz] * 2];
+            const int* source = values + ((firstLayer + ly) * kSection + range.skipZ + lz) * kSection + range.skipX;
+            for (int lx = 0; lx < range.endX - range.beginX; lx++) {
+                int paletteIndex = source[lx];
+                if (paletteIndex < 0 || static_cast<size_t>(paletteIndex) >= paletteSize) {
+                    out.skipped++;
+                    continue;
+                }
+
+                switch (palette.kinds[paletteIndex]) {
+                case PaletteEntryKind::Air:
+                    out.skipped++;
+                    break;
+                case PaletteEntryKind::Unresolved:
+                    out.failed++;
+                    break;
+                case PaletteEntryKind::Place:
+                    row[range.pieceX[lx]].push_back(
+                        {BlockCommand::pack(range.localX[lx], worldY + ly, range.localZ[lz]),
+                         static_cast<uint32_t>(paletteIndex)}
+                    );
+                    break;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void appendBlockEntityCommands(PlacementPlan& plan, const BlockEntityStore& store,
+                               const std::vector<uint64_t>& sortedPositions, const Schematic& window, int windowY,
+                               int windowZ, const ResolvedPalette& palette, int originX, int originY, int originZ,
+                               const PlacementClip* clip) {
+    // Sorted by Y, then Z: the window's rows of each layer are one contiguous range
+    std::vector<uint64_t> positions;
+    for (int y = windowY; y < windowY + window.height; y++) {
+        auto first = std::lower_bound(sortedPositions.begin(), sortedPositions.end(),
+                                      BlockEntityStore::packPosition(0, y, windowZ));
+        auto last = std::lower_bound(first, sortedPositions.end(),
+                                     BlockEntityStore::packPosition(0, y, windowZ + window.length));
+        positions.insert(positions.end(), first, last);
+    }
+    std::vector<BlockEntityCommand> commands(positions.size());
+
+    WorkerPool::getInstance().parallelFor(positions.size(), [&](size_t i) {
+        int x, y, z;
+        BlockEntityStore::unpackPosition(positions[i], x, y, z);
+        if (clip && !clip->contains(x, y, z)) {
+            return;
+        }
+
+        // -1 outside the window
+        int paletteIndex = window.blocks.get(x, y - windowY, z - windowZ);
+        if (paletteIndex < 0 || static_cast<size_t>(paletteIndex) >= palette.kinds.size()
+            || palette.kinds[paletteIndex] != PaletteEntryKind::Place) {
+            return;
+        }
+
+        try {
+            auto entity = store.find(x, y, z);
+            if (!entity) {
+                return;
+            }
+            auto& command = commands[i];
+            command.x = originX + x;
+            command.y = originY + y;
+            command.z = originZ + z;
+            command.nbt = convertBlockEntityToBedrock(*entity, command.x, command.y, command.z);
+        } catch (const std::exception&) {
+            // Malformed entry: the block is still placed, just without its data
+        }
+    });
+
+    for (auto& command : commands) {
+        if (!command.nbt.empty()) {
+            plan.blockEntities.push_back(std::move(command));
+        }
+    }
+}
+
+PlacementPlan buildPlacementPlan(const Schematic& schem, const ResolvedPalette& palette, int baseX, int baseY,
+                                 int baseZ, const PlacementClip* clip) {
+    WA_TRACE_ZONE("build plan");
+    PlacementPlan plan;
+    plan.blocks = palette.blocks;
+
+    auto requested = getPlacementBounds(schem, clip);
+    if (isEmpty(requested)) {
+        return plan;
+    }
+    if (schem.blocks.empty()) {
+        plan.skipped = getVolume(requested);
+        return plan;
+    }
+
+    // Air around the content is counted, never visited
+    auto bounds = getContentBounds(schem, requested);
+    plan.skipped = getVolume(requested) - getVolume(bounds);
+    if (isEmpty(bounds)) {
+        return plan;
+    }
+
+    PlacementGrid grid(schem, baseX, baseY, baseZ, bounds);
+    const auto& blocks = schem.blocks;
+    size_t sectionColumns = static_cast<size_t>(blocks.getSectionsX()) * blocks.getSectionsZ();
+    size_t paletteSize = palette.kinds.size();
+
+    // Section ranges overlapping the bounds, and those of sections entirely inside them
+    int firstSectionY = bounds.minY / kSection, lastSectionY = (bounds.maxY - 1) / kSection;
+    int fullX0 = (bounds.minX + kSection - 1) / kSection, fullX1 = bounds.maxX / kSection;
+    int fullY0 = (bounds.minY + kSection - 1) / kSection, fullY1 = bounds.maxY / kSection;
+    int fullZ0 = (bounds.minZ + kSection - 1) / kSection, fullZ1 = bounds.maxZ / kSection;
+
+    // Stage 0: full sections whose contents repeat (tiled floors, facades) are compiled
+    // once with section-relative Y. Every full section sits at the same offset from the
+    // chunk grid horizontally, so only Y needs adjusting when a compiled one is reused.
+    std::vector<int32_t> templateOf(blocks.getSectionCount(), -1);
+    std::vector<size_t> templateSources;
+    {
+        std::unordered_map<uint64_t, int32_t> slotByOffset;
+        std::vector<size_t> slotSources;
+        std::vector<uint32_t> slotUses;
+        for (int sectionY = fullY0; sectionY < fullY1; sectionY++) {
+            for (int sectionZ = fullZ0; sectionZ < fullZ1; sectionZ++) {
+                for (int sectionX = fullX0; sectionX < fullX1; sectionX++) {
+                    size_t index = blocks.getSectionIndex(sectionX, sectionY, sectionZ);
+                    const auto& section = blocks.getSection(index);
+                    if (section.kind == SectionedBlocks::Kind::Uniform) {
+                        continue;
+                    }
+                    auto slot = static_cast<int32_t>(slotUses.size());
+                    auto [it, inserted] = slotByOffset.try_emplace(section.offset, slot);
+                    if (inserted) {
+                        slotSources.push_back(index);
+                        slotUses.push_back(0);
+                    }
+                    slotUses[it->second]++;
+                    templateOf[index] = it->second;
+                }
+            }
+        }
+
+        std::vector<int32_t> templateOfSlot(slotUses.size(), -1);
+        for (size_t slot = 0; slot < slotUses.size(); slot++) {
+            if (slotUses[slot] > 1) {
+                templateOfSlot[slot] = static_cast<int32_t>(templateSources.size());
+                templateSources.push_back(slotSources[slot]);
+            }
+        }
+        for (auto& slot : templateOf) {
+            if (slot >= 0) {
+                slot = templateOfSlot[slot];
+            }
+        }
+    }
+
+    std::vector<SectionCommands> templates(templateSources.size());
+    WorkerPool::getInstance().parallelFor(templateSources.size(), [&](size_t i) {
+        WA_TRACE_ZONE("compile template");
+        size_t index = templateSources[i];
+        size_t column = index % (static_cast<size_t>(blocks.getSectionsX()) * blocks.getSectionsZ());
+        int values[SectionedBlocks::kVolume];
+        blocks.decode(index, values);
+        compileSection(values, SectionColumn(schem, grid, column, bounds), 0, kSection, 0, palette, templates[i]);
+    });
+
+    // Stage 1: decode every other section once, bottom to top, splitting its writes by
+    // chunk column. Each worker owns whole section columns, so pieces never need locking.
+    // Sections outside the bounds are never visited.
+    std::vector<SectionCommands> pieces(sectionColumns);
+    WorkerPool::getInstance().parallelFor(sectionColumns, [&](size_t column) {
+        SectionColumn range(schem, grid, column, bounds);
+        if (range.empty()) {
+            return;
+        }
+        WA_TRACE_ZONE("compile section column");
+        auto& out = pieces[column];
+        if (isColumnEmpty(schem, range)) {
+            out.skipped += range.getVoxelCount(bounds.minY, bounds.maxY);
+            return;
+        }
+        int values[SectionedBlocks::kVolume];
+
+        for (int sectionY = firstSectionY; sectionY <= lastSectionY; sectionY++) {
+            size_t index = blocks.getSectionIndex(range.sectionX, sectionY, range.sectionZ);
+            const auto& section = blocks.getSection(index);
+            int beginY = std::max(sectionY * kSection, bounds.minY);
+            int endY = std::min(sectionY * kSection + kSection, bounds.maxY);
+            int worldY = grid.originY + beginY;
+
+            if (areLayersEmpty(schem, beginY, endY)) {
+                out.skipped += range.getVoxelCount(beginY, endY);
+                continue;
+            }
+
+            // Uniform air or unresolved sections are settled without touching voxels
+            if (section.kind == SectionedBlocks::Kind::Uniform) {
+                int value = section.value;
+                if (value < 0 || static_cast<size_t>(value) >= paletteSize
+                    || palette.kinds[value] == PaletteEntryKind::Air) {
+                    out.skipped += range.getVoxelCount(beginY, endY);
+                    continue;
+                }
+                if (palette.kinds[value] == PaletteEntryKind::Unresolved) {
+                    out.failed += range.getVoxelCount(beginY, endY);
+                    continue;
+                }
+            }
+
+            if (templateOf[index] >= 0) {
+                const auto& compiled = templates[templateOf[index]];
+                auto shift = static_cast<uint32_t>(worldY) << 8; // Wraps correctly below Y 0
+                for (int piece = 0; piece < 4; piece++) {
+                    auto& target = out.pieces[piece];
+                    for (const auto& command : compiled.pieces[piece]) {
+                        target.push_back({command.packedPos + shift, command.blockIndex});
+                    }
+                }
+                out.skipped += compiled.skipped;
+                out.failed += compiled.failed;
+                continue;
+            }
+
+            blocks.decode(index, values);
+            compileSection(values, range, beginY - sectionY * kSection, endY - beginY, worldY, palette, out);
+        }
+    });
+    std::vector<SectionCommands>().swap(templates);
+
+    // Stage 2: each chunk column gathers the pieces (at most 2x2) that land in it
+    size_t columnCount = static_cast<size_t>(grid.chunksX) * grid.chunksZ;
+    plan.chunks.resize(columnCount);
+    WorkerPool::getInstance().parallelFor(columnCount, [&](size_t column) {
+        WA_TRACE_ZONE("gather chunk column");
+        auto& buffer = plan.chunks[column];
+        buffer.chunkX = grid.minChunkX + static_cast<int>(column % grid.chunksX);
+        buffer.chunkZ = grid.minChunkZ + static_cast<int>(column / grid.chunksX);
+
+        // Schematic-local range that lands in this column
+        int beginX = std::max(bounds.minX, buffer.chunkX * 16 - grid.originX);
+        int endX = std::min(bounds.maxX, buffer.chunkX * 16 + 16 - grid.originX);
+        int beginZ = std::max(bounds.minZ, buffer.chunkZ * 16 - grid.originZ);
+        int endZ = std::min(bounds.maxZ, buffer.chunkZ * 16 + 16 - grid.originZ);
+
+        std::vector<BlockCommand>* sources[4];
+        size_t cursors[4] = {};
+        int sourceCount = 0;
+        size_t total = 0;
+        for (int sectionZ = beginZ / kSection; sectionZ <= (endZ - 1) / kSection; sectionZ++) {
+            for (int sectionX = beginX / kSection; sectionX <= (endX - 1) / kSection; sectionX++) {
+                int pieceX = buffer.chunkX - ((grid.originX + sectionX * kSection) >> 4);
+                int pieceZ = buffer.chunkZ - ((grid.originZ + sectionZ * kSection) >> 4);
+                auto& piece = pieces[static_cast<size_t>(sectionZ) * blocks.getSectionsX() + sectionX]
+                                  .pieces[pieceZ * 2 + pieceX];
+                sources[sourceCount++] = &piece;
+                total += piece.size();
+            }
+        }
+
+        // A piece belongs to exactly one chunk column, so it can be taken as is
+        if (sourceCount == 1) {
+            buffer.commands = std::move(*sources[0]);
+            buffer.commands.shrink_to_fit();
+            return;
+        }
+
+        // Interleave layer by layer so the column is still written bottom to top
+        buffer.commands.reserve(total);
+        while (buffer.commands.size() < total) {
+            int worldY = INT_MAX;
+            for (int i = 0; i < sourceCount; i++) {
+                if (cursors[i] < sources[i]->size()) {
+                    worldY = std::min(worldY, (*sources[i])[cursors[i]].worldY());
+                }
+            }
+            for (int i = 0; i < sourceCount; i++) {
+                auto& source = *sources[i];
+                while (cursors[i] < source.size() && source[cursors[i]].worldY() == worldY) {
+                    buffer.commands.push_back(source[cursors[i]++]);
+                }
+            }
+        }
+        for (int i = 0; i < sourceCount; i++) {
+            std::vector<BlockCommand>().swap(*sources[i]);
+        }
+    });
+
+    // Drop columns that ended up empty (all air)
+    plan.chunks.erase(
+        std::remove_if(
+            plan.chunks.begin(),
+            plan.chunks.end(),
+            [](const ChunkCommandBuffer& buffer) { return buffer.commands.empty(); }
+        ),
+        plan.chunks.end()
+    );
+
+    for (const auto& column : pieces) {
+        plan.skipped += column.skipped;
+        plan.failed += column.failed;
+    }
+
+    if (schem.blockEntities && !schem.blockEntities->empty()) {
+        appendBlockEntityCommands(
+            plan, *schem.blockEntities, schem.blockEntities->getPositions(), schem, 0, 0, palette, grid.originX,
+            grid.originY, grid.originZ, clip
+        );
+    }
+    return plan;
+}
+
+PasteEstimate estimatePlacement(const Schematic& schem, const ResolvedPalette& palette, int baseX, int baseY,
+                                int baseZ) {
+    WA_TRACE_ZONE("estimate");
+    PasteEstimate estimate;
+    if (schem.blockEntities) {
+        estimate.blockEntities = schem.blockEntities->getEntryCount();
+    }
+
+    if (schem.width <= 0 || schem.height <= 0 || schem.length <= 0) {
+        return estimate;
+    }
+    if (schem.blocks.empty()) {
+        estimate.skipped = schem.getBlockCount();
+        return estimate;
+    }
+
+    auto requested = getPlacementBounds(schem, nullptr);
+    auto bounds = getContentBounds(schem, requested);
+    estimate.skipped = getVolume(requested) - getVolume(bounds);
+    if (isEmpty(bounds)) {
+        return estimate;
+    }
+    PlacementGrid grid(schem, baseX, baseY, baseZ, bounds);
+    const auto& blocks = schem.blocks;
+    size_t sectionColumns = static_cast<size_t>(blocks.getSectionsX()) * blocks.getSectionsZ();
+    size_t paletteSize = palette.kinds.size();
+    int minSection = grid.originY >> 4;
+
+    // Per section column: voxel count per palette index plus the world sections it
+    // writes to, keyed (chunk column << 32) | (section - minSection)
+    struct ColumnCounts {
+        std::vector<size_t> histogram;
+        size_t missing = 0;
+        size_t empty = 0; // Voxels the occupancy proves are air
+        std::vector<uint64_t> touched;
+    };
+    std::vector<ColumnCounts> columns(sectionColumns);
+
+    std::vector<uint8_t> places(paletteSize);
+    for (size_t i = 0; i < paletteSize; i++) {
+        places[i] = palette.kinds[i] == PaletteEntryKind::Place ? 1 : 0;
+    }
+
+    WorkerPool::getInstance().parallelFor(sectionColumns, [&](size_t column) {
+        SectionColumn range(schem, grid, column, bounds);
+        auto& counts = columns[column];
+        counts.histogram.assign(paletteSize, 0);
+        if (range.empty()) {
+            return;
+        }
+        if (isColumnEmpty(schem, range)) {
+            counts.empty += range.getVoxelCount(bounds.minY, bounds.maxY);
+            return;
+        }
+        int values[SectionedBlocks::kVolume];
+
+        for (int sectionY = bounds.minY / kSection; sectionY <= (bounds.maxY - 1) / kSection; sectionY++) {
+            size_t index = blocks.getSectionIndex(range.sectionX, sectionY, range.sectionZ);
+            const auto& section = blocks.getSection(index);
+            int beginY = std::max(sectionY * kSection, bounds.minY);
+            int endY = std::min(sectionY * kSection + kSection, bounds.maxY);
+            int firstWorldSection = (grid.originY + beginY) >> 4;
+            if (areLayersEmpty(schem, beginY, endY)) {
+                counts.empty += range.getVoxelCount(beginY, endY);
+                continue;
+            }
+
+            // One schematic section overlaps at most 2x2 chunk columns and 2 world sections
+            uint8_t placed[4][2] = {};
+
+            if (section.kind == SectionedBlocks::Kind::Uniform) {
+                int value = section.value;
+                if (value < 0 || static_cast<size_t>(value) >= paletteSize) {
+                    counts.missing += range.getVoxelCount(beginY, endY);
+                    continue;
+                }
+                counts.histogram[value] += range.getVoxelCount(beginY, endY);
+                if (places[value]) {
+                    int lastPieceX = range.pieceX[range.endX - range.beginX - 1];
+                    int lastPieceZ = range.pieceZ[range.endZ - range.beginZ - 1];
+                    int lastWorldSection = ((grid.originY + endY - 1) >> 4) - firstWorldSection;
+                    for (int pieceZ = range.pieceZ[0]; pieceZ <= lastPieceZ; pieceZ++) {
+                        for (int pieceX = range.pieceX[0]; pieceX <= lastPieceX; pieceX++) {
+                            for (int worldSection = 0; worldSection <= lastWorldSection; worldSection++) {
+                                placed[pieceZ * 2 + pieceX][worldSection] = 1;
+                            }
+                        }
+                    }
+                }
+            } else {
+                blocks.decode(index, values);
+                for (int y = beginY; y < endY; y++) {
+                    int worldSection = ((grid.originY + y) >> 4) - firstWorldSection;
+                    for (int z = range.beginZ; z < range.endZ; z++) {
+                        int lz = z - range.beginZ;
+                        int pieceRow = range.pieceZ[lz] * 2;
+                        const int* source =
+                            values + ((y - sectionY * kSection) * kSection + range.skipZ + lz) * kSection + range.skipX;
+                        for (int lx = 0; lx < range.endX - range.beginX; lx++) {
+                            int paletteIndex = source[lx];
+                            if (paletteIndex < 0 || static_cast<size_t>(paletteIndex) >= paletteSize) {
+                                counts.missing++;
+                                continue;
+                            }
+                            counts.histogram[paletteIndex]++;
+                            placed[pieceRow + range.pieceX[lx]][worldSection] |= places[paletteIndex];
+                        }
+                    }
+                }
+            }
+
+            for (int piece = 0; piece < 4; piece++) {
+                for (int worldSection = 0; worldSection < 2; worldSection++) {
+                    if (!placed[piece][worldSection]) {
+                        continue;
+                    }
+                    size_t chunkColumn =
+                        grid.getColumnIndex(range.firstChunkX + piece % 2, range.firstChunkZ + piece / 2);
+                    counts.touched.push_back(
+                        (static_cast<uint64_t>(chunkColumn) << 32)
+                        | static_cast<uint32_t>(firstWorldSection + worldSection - minSection)
+                    );
+                }
+            }
+        }
+    });
+
+    std::vector<size_t> histogram(paletteSize, 0);
+    std::vector<uint64_t> touched;
+    for (const auto& counts : columns) {
+        for (size_t i = 0; i < paletteSize; i++) {
+            histogram[i] += counts.histogram[i];
+        }
+        estimate.skipped += counts.missing + counts.empty;
+        touched.insert(touched.end(), counts.touched.begin(), counts.touched.end());
+    }
+
+    // Neighbouring section columns share chunk columns: count each world section once
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    estimate.subchunks = touched.size();
+    for (size_t i = 0; i < touched.size(); i++) {
+        if (i == 0 || (touched[i] >> 32) != (touched[i - 1] >> 32)) {
+            estimate.chunks++;
+        }
+    }
+
+    for (size_t i = 0; i < paletteSize; i++) {
+        switch (palette.kinds[i]) {
+        case PaletteEntryKind::Place:
+            estimate.blocks += histogram[i];
+            break;
+        case PaletteEntryKind::Air:
+            estimate.skipped += histogram[i];
+            break;
+        case PaletteEntryKind::Unresolved:
+            estimate.failed += histogram[i];
+            if (histogram[i] > 0 && i < schem.palette.size()) {
+                estimate.unresolved.emplace_back(schem.palette[i].toString(), histogram[i]);
+            }
+            break;
+        }
+    }
+
+    std::sort(estimate.unresolved.begin(), estimate.unresolved.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    return estimate;
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "mod/SchematicReader.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Block;
+
+namespace wooden_axe {
+
+// What a palette entry turns into once resolved against the block registry
+enum class PaletteEntryKind : uint8_t {
+    Place = 0,
+    Air = 1,
+    Unresolved = 2
+};
+
+// Palette resolved on the server thread, indexed like Schematic::palette
+struct ResolvedPalette {
+    std::vector<const Block*> blocks;
+    std::vector<PaletteEntryKind> kinds;
+};
+
+// A single queued write inside one chunk column
+struct BlockCommand {
+    uint32_t packedPos;  // (worldY << 8) | (localZ << 4) | localX
+    uint32_t blockIndex; // Index into PlacementPlan::blocks
+
+    static uint32_t pack(int localX, int worldY, int localZ) {
+        return (static_cast<uint32_t>(worldY) << 8) | (static_cast<uint32_t>(localZ) << 4)
+             | static_cast<uint32_t>(localX);
+    }
+
+    int localX() const { return static_cast<int>(packedPos & 0xF); }
+    int localZ() const { return static_cast<int>((packedPos >> 4) & 0xF); }
+    int worldY() const { return static_cast<int32_t>(packedPos) >> 8; }
+};
+
+// All writes that fall into one chunk column, ordered bottom to top
+struct ChunkCommandBuffer {
+    static constexpr size_t kSectionVolume = 16 * 16 * 16;
+
+    int chunkX = 0;
+    int chunkZ = 0;
+    std::vector<BlockCommand> commands;
+
+    // Whether commands [begin, begin + 4096) are exactly one whole 16x16x16 section.
+    // Positions are unique and Y-ordered, so checking the ends of the run is enough.
+    bool isFullSectionAt(size_t begin) const {
+        if (begin + kSectionVolume > commands.size()) {
+            return false;
+        }
+        int section = commands[begin].worldY() >> 4;
+        return (begin == 0 || (commands[begin - 1].worldY() >> 4) != section)
+            && (commands[begin + kSectionVolume - 1].worldY() >> 4) == section
+            && (begin + kSectionVolume == commands.size()
+                || (commands[begin + kSectionVolume].worldY() >> 4) != section);
+    }
+};
+
+// Block-actor data to load once its block has been written
+struct BlockEntityCommand {
+    int x = 0, y = 0, z = 0; // World position
+    std::string nbt;         // Bedrock little-endian NBT
+};
+
+// Output of the worker stage; the server thread only has to drain it
+struct PlacementPlan {
+    std::vector<const Block*> blocks;
+    std::vector<ChunkCommandBuffer> chunks;
+    std::vector<BlockEntityCommand> blockEntities;
+    size_t skipped = 0; // Air or missing voxels
+    size_t failed = 0;  // Voxels whose palette entry did not resolve
+
+    size_t getCommandCount() const {
+        size_t total = 0;
+        for (const auto& chunk : chunks) {
+            total += chunk.commands.size();
+        }
+        return total;
+    }
+};
+
+// Schematic-local box a paste is restricted to: [min, max) on each axis
+struct PlacementClip {
+    int minX = 0, minY = 0, minZ = 0;
+    int maxX = 0, maxY = 0, maxZ = 0;
+
+    bool contains(int x, int y, int z) const {
+        return x >= minX && x < maxX && y >= minY && y < maxY && z >= minZ && z < maxZ;
+    }
+};
+
+// What a paste would do, computed without building commands or touching the world
+struct PasteEstimate {
+    size_t blocks = 0;        // Voxels that would be written
+    size_t skipped = 0;       // Air or missing voxels
+    size_t failed = 0;        // Voxels whose palette entry did not resolve
+    size_t blockEntities = 0; // Upper bound: entries in the schematic
+    size_t chunks = 0;        // Chunk columns with at least one write
+    size_t subchunks = 0;     // 16x16x16 sections with at least one write
+    std::vector<std::pair<std::string, size_t>> unresolved; // Palette name, voxel count (most first)
+};
+
+// Count what a paste at the given position would write.
+// Only per-palette histograms and per-section flags, no per-voxel allocation.
+PasteEstimate estimatePlacement(const Schematic& schem, const ResolvedPalette& palette, int baseX, int baseY,
+                                int baseZ);
+
+// Turn a schematic into per-chunk command buffers on the worker pool.
+// Pure CPU work: safe to run off the server thread. With a clip only the sections it
+// overlaps are visited and only voxels inside it are planned or counted.
+PlacementPlan buildPlacementPlan(const Schematic& schem, const ResolvedPalette& palette, int baseX, int baseY,
+                                 int baseZ, const PlacementClip* clip = nullptr);
+
+// Add commands for the block entities whose block is placed from `window`, which holds
+// rows [windowZ, windowZ + length) of layers [windowY, windowY + height) of the schematic.
+// `positions` is store.getPositions(), fetched once per paste; only the window's part is visited.
+// Entity positions are schematic-local; origin is the world position of local (0, 0, 0).
+// Entities outside `clip` (schematic-local, optional) are left out.
+void appendBlockEntityCommands(PlacementPlan& plan, const BlockEntityStore& store,
+                               const std::vector<uint64_t>& positions, const Schematic& window, int windowY,
+                               int windowZ, const ResolvedPalette& palette, int originX, int originY, int originZ,
+                               const PlacementClip* clip = nullptr);
+
+} // namespace wooden_axe
@@ -0,0 +1,136 @@
+#include "mod/SchematicCache.h"
+#include "mod/WoodenAxeMod.h"
+#include "mod/WorkerPool.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace wooden_axe {
+
+namespace {
+
+// Progress shared by the tasks of one prewarm
+struct PrewarmProgress {
+    size_t total = 0;
+    std::atomic<size_t> finished{0};
+    std::atomic<size_t> loaded{0};
+    std::chrono::steady_clock::time_point start;
+};
+
+double getElapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+void SchematicCache::prewarm(const std::vector<std::string>& filenames, const std::string& directory) {
+    if (filenames.empty()) {
+        return;
+    }
+    auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+    logger.info("Prewarming {} schematics on {} worker threads", filenames.size(),
+                WorkerPool::getInstance().getThreadCount());
+
+    uint64_t generation;
+    {
+        std::lock_guard lock(mMutex);
+        generation = mGeneration;
+    }
+
+    auto progress = std::make_shared<PrewarmProgress>();
+    progress->total = filenames.size();
+    progress->start = std::chrono::steady_clock::now();
+
+    for (const auto& filename : filenames) {
+        std::string path = (std::filesystem::path(directory) / filename).string();
+        WorkerPool::getInstance().submit([this, path, filename, generation, progress] {
+            auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+            auto start = std::chrono::steady_clock::now();
+
+            // Stamp the file before reading it, so a write during the load invalidates the entry
+            std::error_code ec;
+            auto modified = std::filesystem::last_write_time(path, ec);
+            auto fileSize = ec ? 0 : std::filesystem::file_size(path, ec);
+            std::optional<Schematic> schem;
+            if (!ec) {
+                schem = SchematicReader::loadFromFile(path);
+            }
+
+            size_t finished = progress->finished.fetch_add(1) + 1;
+            if (!schem) {
+                logger.warn("Prewarm [{}/{}] failed: {} ({:.0f} ms)", finished, progress->total, filename,
+                            getElapsedMs(start));
+            } else {
+                auto entry = Entry{std::make_shared<const Schematic>(std::move(*schem)), modified, fileSize};
+                size_t bytes = entry.schem->getMemoryUsage();
+                {
+                    std::lock_guard lock(mMutex);
+                    if (mGeneration != generation) {
+                        return; // Disabled meanwhile
+                    }
+                    mEntries[path] = std::move(entry);
+                }
+                progress->loaded++;
+                logger.info("Prewarm [{}/{}] {} in {:.0f} ms ({} KB)", finished, progress->total, filename,
+                            getElapsedMs(start), bytes / 1024);
+            }
+
+            if (finished == progress->total) {
+                logger.info("Prewarmed {} of {} schematics in {:.0f} ms", progress->loaded.load(), progress->total,
+                            getElapsedMs(progress->start));
+            }
+        });
+    }
+}
+
+std::shared_ptr<const Schematic> SchematicCache::find(const std::string& path) {
+    std::lock_guard lock(mMutex);
+    auto it = mEntries.find(path);
+    if (it == mEntries.end()) {
+        return nullptr;
+    }
+
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    auto fileSize = ec ? 0 : std::filesystem::file_size(path, ec);
+    if (ec || modified != it->second.modified || fileSize != it->second.fileSize) {
+        mEntries.erase(it); // Changed on disk: the caller loads the new version
+        return nullptr;
+    }
+    return it->second.schem;
+}
+
+bool SchematicCache::contains(const std::shared_ptr<const Schematic>& schem) const {
+    if (!schem) {
+        return false;
+    }
+    std::lock_guard lock(mMutex);
+    for (const auto& [path, entry] : mEntries) {
+        if (entry.schem == schem) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t SchematicCache::getEntryCount() const {
+    std::lock_guard lock(mMutex);
+    return mEntries.size();
+}
+
+size_t SchematicCache::getMemoryUsage() const {
+    std::lock_guard lock(mMutex);
+    size_t total = 0;
+    for (const auto& [path, entry] : mEntries) {
+        total += entry.schem->getMemoryUsage();
+    }
+    return total;
+}
+
+void SchematicCache::clear() {
+    std::lock_guard lock(mMutex);
+    mEntries.clear();
+    mGeneration++;
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "mod/SchematicReader.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wooden_axe {
+
+// Schematics loaded ahead of time (Config::prewarmSchematics) and shared by every session
+// that loads them. Entries are immutable and stay until the file changes on disk or the
+// mod is disabled; clipboards pointing at them are not counted or evicted by SessionStore.
+class SchematicCache {
+public:
+    static SchematicCache& getInstance() {
+        static SchematicCache instance;
+        return instance;
+    }
+
+    // Load each file (relative to directory) as its own worker pool task; returns at once
+    void prewarm(const std::vector<std::string>& filenames, const std::string& directory);
+
+    // The cached copy of a file, unless it was never prewarmed or has changed since
+    std::shared_ptr<const Schematic> find(const std::string& path);
+
+    bool contains(const std::shared_ptr<const Schematic>& schem) const;
+
+    size_t getEntryCount() const;
+    size_t getMemoryUsage() const;
+
+    // Drop every entry; loads still running are discarded when they finish
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const Schematic> schem;
+        std::filesystem::file_time_type modified;
+        uintmax_t fileSize = 0;
+    };
+
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, Entry> mEntries;
+    uint64_t mGeneration = 0;
+};
+
+} // namespace wooden_axe
@@ -1,35 +1,19 @@
 #include "mod/SchematicPlacer.h"
+#include "mod/BlockEntities.h"
+#include "mod/SchematicStream.h"
 #include "mod/WoodenAxeMod.h"
+#include "mod/WorkerPool.h"
 
-#include "ll/api/service/Bedrock.h"
-#include "mc/world/level/Level.h"
-#include "mc/world/level/dimension/Dimension.h"
-#include "mc/world/level/block/Block.h"
-#include "mc/world/level/block/registry/BlockTypeRegistry.h"
-#include "mc/world/level/BlockSource.h"
-#include "mc/server/commands/CommandUtils.h"
+#include "ll/api/thread/ServerThreadExecutor.h"
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <unordered_map>
+#include <utility>
 
 namespace wooden_axe {
 
-void SchematicPlacer::setLoadedSchematic(const std::string& playerName, Schematic schem) {
-    mLoadedSchematics[playerName] = std::move(schem);
-}
-
-Schematic* SchematicPlacer::getLoadedSchematic(const std::string& playerName) {
-    auto it = mLoadedSchematics.find(playerName);
-    if (it != mLoadedSchematics.end()) {
-        return &it->second;
-    }
-    return nullptr;
-}
-
-void SchematicPlacer::clearLoadedSchematic(const std::string& playerName) {
-    mLoadedSchematics.erase(playerName);
-}
-
 std::string SchematicPlacer::convertBlockName(const std::string& javaName) {
     // Basic Java -> Bedrock block name mapping
     // Most blocks have the same name, but some need conversion
@@ -188,87 +172,301 @@ std::string SchematicPlacer::buildBlockState(const SchematicBlock& block) {
     return bedrockName;
 }
 
-int SchematicPlacer::placeSchematic(const Schematic& schem, int baseX, int baseY, int baseZ, int dimension) {
+ResolvedPalette SchematicPlacer::resolvePalette(const Schematic& schem, WorldSink& sink) {
+    WA_TRACE_ZONE("resolve palette");
     auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
     
-    auto* level = ll::service::getLevel();
-    if (!level) {
-        logger.error("Failed to get level");
-        return -1;
-    }
+    ResolvedPalette resolved;
+    resolved.blocks.resize(schem.palette.size(), nullptr);
+    resolved.kinds.resize(schem.palette.size(), PaletteEntryKind::Unresolved);
     
-    // Get dimension
-    auto* dim = level->getDimension(dimension).get();
-    if (!dim) {
-        logger.error("Failed to get dimension {}", dimension);
-        return -1;
+    // One registry lookup per palette entry instead of per voxel
+    for (size_t i = 0; i < schem.palette.size(); i++) {
+        const auto& block = schem.palette[i];
+        
+        if (block.isAir()) {
+            resolved.kinds[i] = PaletteEntryKind::Air;
+            continue;
+        }
+        
+        std::string blockName;
+        {
+            WA_TRACE_ZONE("translate name");
+            blockName = buildBlockState(block);
+        }
+        const Block* bedrockBlock;
+        {
+            WA_TRACE_ZONE("registry lookup");
+            bedrockBlock = sink.resolveBlock(blockName);
+        }
+        if (bedrockBlock) {
+            resolved.blocks[i] = bedrockBlock;
+            resolved.kinds[i] = PaletteEntryKind::Place;
+        } else {
+            logger.debug("Block not found: {}, original: {}", blockName, block.name);
+        }
     }
     
-    auto& blockSource = dim->getBlockSourceFromMainChunkSource();
+    return resolved;
+}
+
+PasteEstimate SchematicPlacer::estimate(const Schematic& schem, int baseX, int baseY, int baseZ, WorldSink& sink) {
+    auto start = std::chrono::steady_clock::now();
     
-    int placed = 0;
-    int skipped = 0;
-    int failed = 0;
+    auto palette = resolvePalette(schem, sink);
+    auto result = estimatePlacement(schem, palette, baseX, baseY, baseZ);
     
-    logger.info("Placing schematic {}x{}x{} at ({}, {}, {})", 
-                schem.width, schem.height, schem.length, baseX, baseY, baseZ);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    WoodenAxeMod::getInstance().getSelf().getLogger().debug(
+        "Estimated paste of {}x{}x{} in {:.2f} ms", schem.width, schem.height, schem.length, elapsed
+    );
+    return result;
+}
+
+// Worker-side state of a streamed paste: one decoder and the grid it decodes into, reused per window
+struct StreamedPaste {
+    StreamedPaste(std::shared_ptr<const Schematic> schem, std::shared_ptr<const ResolvedPalette> palette, int baseX,
+                  int baseY, int baseZ, size_t windowVoxels)
+    : schem(schem),
+      palette(std::move(palette)),
+      reader(schem->stream, schem->width, schem->height, schem->length, windowVoxels),
+      baseX(baseX),
+      baseY(baseY),
+      baseZ(baseZ) {
+        window.width = schem->width;
+        window.offsetX = schem->offsetX;
+    }
     
-    // Place blocks
-    for (int y = 0; y < schem.height; y++) {
-        for (int z = 0; z < schem.length; z++) {
-            for (int x = 0; x < schem.width; x++) {
-                auto blockOpt = schem.getBlock(x, y, z);
-                if (!blockOpt) {
-                    skipped++;
-                    continue;
-                }
-                
-                const auto& block = *blockOpt;
+    std::shared_ptr<const Schematic> schem;
+    std::shared_ptr<const ResolvedPalette> palette;
+    StreamWindowReader reader;
+    std::vector<int> buffer; // Decoded voxels of the current window, reused
+    Schematic window;
+    int baseX, baseY, baseZ;
+    std::optional<PlacementClip> clip; // Schematic-local
+    std::optional<std::vector<uint64_t>> entityPositions; // Sorted, fetched with the first window
+};
+
+// Part of a schematic pasted at base that falls inside a world box, in schematic-local coordinates
+static PlacementClip toPlacementClip(const BlockBox& box, const Schematic& schem, int baseX, int baseY, int baseZ) {
+    int originX = baseX + schem.offsetX;
+    int originY = baseY + schem.offsetY;
+    int originZ = baseZ + schem.offsetZ;
+    return PlacementClip{
+        box.min.x - originX,     box.min.y - originY,     box.min.z - originZ,
+        box.max.x - originX + 1, box.max.y - originY + 1, box.max.z - originZ + 1
+    };
+}
+
+// Decode the next window on a worker and hand its plan to the job.
+// Only one call runs at a time per paste: the job asks for the next window once it starts on this one.
+static void decodeNextWindow(std::shared_ptr<StreamedPaste> paste, std::weak_ptr<PasteJob> weakJob) {
+    WorkerPool::getInstance().submit([paste, weakJob] {
+        WA_TRACE_ZONE("stream window");
+        std::shared_ptr<const PlacementPlan> plan;
+        std::string error;
+        StreamWindow range;
+        try {
+            if (paste->reader.next(range, paste->buffer)) {
+                const auto& schem = *paste->schem;
+                auto& window = paste->window;
+                window.height = range.layers;
+                window.length = range.rows;
+                // Sectioned but not deflated: the window is read once and then dropped
+                window.blocks = SectionedBlocks::fromGrid(paste->buffer.data(), paste->buffer.size(), window.width,
+                                                          window.height, window.length, false);
+                window.offsetY = schem.offsetY + range.y;
+                window.offsetZ = schem.offsetZ + range.z;
                 
-                // Skip air blocks
-                if (block.name == "minecraft:air" || block.name == "air") {
-                    skipped++;
-                    continue;
+                // The clip in window coordinates; windows outside it plan nothing
+                std::optional<PlacementClip> windowClip;
+                if (paste->clip) {
+                    windowClip = *paste->clip;
+                    windowClip->minY -= range.y;
+                    windowClip->maxY -= range.y;
+                    windowClip->minZ -= range.z;
+                    windowClip->maxZ -= range.z;
                 }
                 
-                // Calculate world position
-                int worldX = baseX + x + schem.offsetX;
-                int worldY = baseY + y + schem.offsetY;
-                int worldZ = baseZ + z + schem.offsetZ;
-                
-                // Get block to place
-                std::string blockName = buildBlockState(block);
-                
-                try {
-                    // Try to get the block from registry
-                    const Block* bedrockBlock = BlockTypeRegistry::lookupByName(blockName, false);
-                    
-                    if (bedrockBlock) {
-                        BlockPos pos(worldX, worldY, worldZ);
-                        blockSource.setBlock(pos, *bedrockBlock, 3, nullptr, nullptr);
-                        placed++;
-                    } else {
-                        // Fallback: try with just minecraft:stone if block not found
-                        logger.debug("Block not found: {}, original: {}", blockName, block.name);
-                        failed++;
+                auto built = buildPlacementPlan(window, *paste->palette, paste->baseX, paste->baseY, paste->baseZ,
+                                                windowClip ? &*windowClip : nullptr);
+                if (schem.blockEntities && !schem.blockEntities->empty()) {
+                    if (!paste->entityPositions) {
+                        paste->entityPositions = schem.blockEntities->getPositions();
                     }
-                } catch (const std::exception& e) {
-                    logger.debug("Failed to place block at ({}, {}, {}): {}", worldX, worldY, worldZ, e.what());
-                    failed++;
+                    appendBlockEntityCommands(built, *schem.blockEntities, *paste->entityPositions, window, range.y,
+                                              range.z, *paste->palette, paste->baseX + schem.offsetX,
+                                              paste->baseY + schem.offsetY, paste->baseZ + schem.offsetZ,
+                                              paste->clip ? &*paste->clip : nullptr);
                 }
+                plan = std::make_shared<const PlacementPlan>(std::move(built));
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        bool last = paste->reader.isFinished();
+        if (paste->clip && error.empty()) {
+            // Windows run bottom to top: stop once the rest of the file lies above the clip
+            bool layerDone = range.z + range.rows >= paste->schem->length;
+            last = last || (layerDone ? range.y + range.layers : range.y) >= paste->clip->maxY;
+        }
+        
+        ll::thread::ServerThreadExecutor::getDefault().execute([weakJob, plan, last, error] {
+            auto job = weakJob.lock();
+            if (!job || !job->isActive()) {
+                return; // Cancelled: the chain stops and the decoder is released
+            }
+            if (!error.empty()) {
+                job->failPlans(error);
+            } else {
+                job->addPlan(plan ? plan : std::make_shared<const PlacementPlan>(), last);
             }
+        });
+    });
+}
+
+std::shared_ptr<PasteJob> SchematicPlacer::pasteAsync(std::shared_ptr<const Schematic> schem, int baseX, int baseY,
+                                                      int baseZ, std::shared_ptr<WorldSink> sink, std::string owner,
+                                                      const PasteOptions& options,
+                                                      std::function<void(const PlaceResult&)> onComplete) {
+    auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+    
+    logger.info("Placing schematic {}x{}x{} at ({}, {}, {})", 
+                schem->width, schem->height, schem->length, baseX, baseY, baseZ);
+    
+    std::string description = "paste " + std::to_string(schem->width) + "x" + std::to_string(schem->height) + "x"
+                            + std::to_string(schem->length) + " at (" + std::to_string(baseX) + ", "
+                            + std::to_string(baseY) + ", " + std::to_string(baseZ) + ")";
+    // Created first so its trace covers palette resolution
+    auto job = std::make_shared<PasteJob>(sink, std::move(description), options, std::move(onComplete));
+    auto palette = std::make_shared<ResolvedPalette>(resolvePalette(*schem, *sink));
+    options.mask.applySourceFilter(*palette, *sink);
+    JobScheduler::getInstance().submit(job, std::move(owner), options.priority);
+    
+    if (schem->stream) {
+        // Bounded memory: at most the window being written, the next one and the decoder's buffer
+        size_t windowVoxels = WoodenAxeMod::getInstance().getConfig().streamWindowBlocks;
+        auto paste = std::make_shared<StreamedPaste>(schem, std::move(palette), baseX, baseY, baseZ, windowVoxels);
+        if (options.clip) {
+            paste->clip = toPlacementClip(*options.clip, *schem, baseX, baseY, baseZ);
         }
+        std::weak_ptr<PasteJob> weakJob = job;
+        job->setPlanSource(paste->reader.getWindowCount(), [paste, weakJob] { decodeNextWindow(paste, weakJob); });
+        decodeNextWindow(paste, weakJob);
+        return job;
+    }
+    
+    // Stage 1 (workers): per-voxel offset math, air filtering and chunk bucketing
+    std::optional<PlacementClip> clip;
+    if (options.clip) {
+        clip = toPlacementClip(*options.clip, *schem, baseX, baseY, baseZ);
+    }
+    WorkerPool::getInstance().submit([schem, palette, baseX, baseY, baseZ, clip, job] {
+        WA_TRACE_ZONE("plan paste");
+        auto plan = std::make_shared<const PlacementPlan>(
+            buildPlacementPlan(*schem, *palette, baseX, baseY, baseZ, clip ? &*clip : nullptr)
+        );
         
-        // Log progress every 16 layers
-        if ((y + 1) % 16 == 0 || y == schem.height - 1) {
-            logger.debug("Progress: layer {}/{}, placed: {}", y + 1, schem.height, placed);
+        // Stage 2 (server thread): the scheduler drains command buffers into the world sink
+        ll::thread::ServerThreadExecutor::getDefault().execute([job, plan] {
+            if (job->isActive()) {
+                job->addPlan(plan, true);
+            }
+        });
+    });
+    
+    return job;
+}
+
+// Copies of a stamp. Copies at the same offset within a chunk share one plan and are
+// replayed from it shifted by whole chunks.
+struct StampedPaste {
+    struct Copy {
+        size_t plan;
+        int chunkOffsetX;
+        int chunkOffsetZ;
+    };
+    
+    std::vector<std::shared_ptr<const PlacementPlan>> plans;
+    std::vector<Copy> copies;
+    size_t next = 0;
+};
+
+std::shared_ptr<PasteJob> SchematicPlacer::stampAsync(std::shared_ptr<const Schematic> schem, int baseX, int baseY,
+                                                      int baseZ, int countX, int countZ, int spacing,
+                                                      std::shared_ptr<WorldSink> sink, std::string owner,
+                                                      const PasteOptions& options,
+                                                      std::function<void(const PlaceResult&)> onComplete) {
+    WoodenAxeMod::getInstance().getSelf().getLogger().info(
+        "Stamping schematic {}x{}x{} {}x{} times at ({}, {}, {})", schem->width, schem->height, schem->length, countX,
+        countZ, baseX, baseY, baseZ
+    );
+    
+    std::string description = "stamp " + std::to_string(schem->width) + "x" + std::to_string(schem->height) + "x"
+                            + std::to_string(schem->length) + " x" + std::to_string(countX * countZ) + " at ("
+                            + std::to_string(baseX) + ", " + std::to_string(baseY) + ", " + std::to_string(baseZ)
+                            + ")";
+    auto job = std::make_shared<PasteJob>(sink, std::move(description), options, std::move(onComplete));
+    auto palette = std::make_shared<ResolvedPalette>(resolvePalette(*schem, *sink));
+    options.mask.applySourceFilter(*palette, *sink);
+    JobScheduler::getInstance().submit(job, std::move(owner), options.priority);
+    
+    // One plan per distinct (x mod 16, z mod 16) of the copy offsets, at most 256
+    auto stamp = std::make_shared<StampedPaste>();
+    std::vector<std::pair<int, int>> phases;
+    std::unordered_map<int, size_t> phaseIndex;
+    int stepX = schem->width + spacing;
+    int stepZ = schem->length + spacing;
+    for (int j = 0; j < countZ; j++) {
+        for (int i = 0; i < countX; i++) {
+            int offsetX = i * stepX;
+            int offsetZ = j * stepZ;
+            auto [it, inserted] = phaseIndex.emplace(((offsetX & 15) << 4) | (offsetZ & 15), phases.size());
+            if (inserted) {
+                phases.emplace_back(offsetX & 15, offsetZ & 15);
+            }
+            stamp->copies.push_back({it->second, offsetX >> 4, offsetZ >> 4});
         }
     }
     
-    logger.info("Schematic placement complete: {} placed, {} skipped (air), {} failed", 
-                placed, skipped, failed);
+    WorkerPool::getInstance().submit([schem, palette, baseX, baseY, baseZ, phases, stamp, job] {
+        WA_TRACE_ZONE("plan stamp");
+        for (const auto& [phaseX, phaseZ] : phases) {
+            stamp->plans.push_back(std::make_shared<const PlacementPlan>(
+                buildPlacementPlan(*schem, *palette, baseX + phaseX, baseY, baseZ + phaseZ)
+            ));
+        }
+        
+        ll::thread::ServerThreadExecutor::getDefault().execute([stamp, job] {
+            if (!job->isActive()) {
+                return;
+            }
+            // Nothing to write: one pass settles the counts, scaled to every copy
+            if (stamp->plans.front()->chunks.empty()) {
+                auto plan = std::make_shared<PlacementPlan>(*stamp->plans.front());
+                plan->skipped *= stamp->copies.size();
+                plan->failed *= stamp->copies.size();
+                job->addPlan(std::move(plan), true);
+                return;
+            }
+            
+            // Each copy is queued as the previous one starts, so only the writes repeat
+            std::weak_ptr<PasteJob> weakJob = job;
+            auto queueNext = [stamp, weakJob] {
+                auto job = weakJob.lock();
+                if (!job || stamp->next >= stamp->copies.size()) {
+                    return;
+                }
+                const auto& copy = stamp->copies[stamp->next++];
+                job->addPlan(stamp->plans[copy.plan], stamp->next == stamp->copies.size(), copy.chunkOffsetX,
+                             copy.chunkOffsetZ);
+            };
+            job->setPlanSource(stamp->copies.size(), queueNext);
+            queueNext();
+        });
+    });
     
-    return placed;
+    return job;
 }
 
 } // namespace wooden_axe
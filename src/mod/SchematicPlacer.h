@@ -1,9 +1,12 @@
 #pragma once
 
+#include "mod/PasteJob.h"
+#include "mod/PlacementPlan.h"
 #include "mod/SchematicReader.h"
-#include <unordered_map>
+#include "mod/WorldSink.h"
+#include <functional>
+#include <memory>
 #include <string>
-#include <optional>
 
 namespace wooden_axe {
 
@@ -14,22 +17,29 @@ public:
         return instance;
     }
     
-    // Store loaded schematic for a player
-    void setLoadedSchematic(const std::string& playerName, Schematic schem);
-    
-    // Get loaded schematic for a player
-    Schematic* getLoadedSchematic(const std::string& playerName);
-    
-    // Clear loaded schematic
-    void clearLoadedSchematic(const std::string& playerName);
-    
-    // Place schematic at position
-    // Returns number of blocks placed, or -1 on error
-    int placeSchematic(const Schematic& schem, int x, int y, int z, int dimension);
+    // Paste schematic at position.
+    // Must be called on the server thread. The plan is built on the worker pool and
+    // written through the job scheduler; onComplete runs on the server thread at the end.
+    // A streamed schematic (Schematic::stream) is decoded and written one window at a time.
+    std::shared_ptr<PasteJob> pasteAsync(std::shared_ptr<const Schematic> schem, int x, int y, int z,
+                                         std::shared_ptr<WorldSink> sink, std::string owner,
+                                         const PasteOptions& options,
+                                         std::function<void(const PlaceResult&)> onComplete);
+
+    // Paste countX by countZ copies, `spacing` blocks apart, from plans compiled once (server thread).
+    // Copies that sit at the same offset within a chunk replay one plan; only the writes repeat.
+    std::shared_ptr<PasteJob> stampAsync(std::shared_ptr<const Schematic> schem, int x, int y, int z, int countX,
+                                         int countZ, int spacing, std::shared_ptr<WorldSink> sink, std::string owner,
+                                         const PasteOptions& options,
+                                         std::function<void(const PlaceResult&)> onComplete);
+
+    // Dry run: what pasteAsync would write, without touching the world (server thread)
+    PasteEstimate estimate(const Schematic& schem, int x, int y, int z, WorldSink& sink);
+
+    // Resolve every palette entry against the sink's blocks (server thread)
+    static ResolvedPalette resolvePalette(const Schematic& schem, WorldSink& sink);
 
 private:
-    std::unordered_map<std::string, Schematic> mLoadedSchematics;
-    
     // Convert Java block name to Bedrock format
     static std::string convertBlockName(const std::string& javaName);
     
@@ -1,279 +1,541 @@
 #include "mod/SchematicReader.h"
-#include "mod/WoodenAxeMod.h"
+#include "mod/BitUnpack.h"
+#include "mod/Log.h"
+#include "mod/Nbt.h"
+#include "mod/NbtVisitor.h"
+#include "mod/ParseArena.h"
+#include "mod/SchematicStream.h"
+#include "mod/Trace.h"
+#include "mod/WorkerPool.h"
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <span>
+#include <string_view>
 #include <fstream>
 #include <filesystem>
 #include <stdexcept>
-#include <cstring>
 #include <zlib.h>
 
 namespace wooden_axe {
 
-// Simple NBT Tag Types
-enum class TagType : uint8_t {
-    End = 0,
-    Byte = 1,
-    Short = 2,
-    Int = 3,
-    Long = 4,
-    Float = 5,
-    Double = 6,
-    ByteArray = 7,
-    String = 8,
-    List = 9,
-    Compound = 10,
-    IntArray = 11,
-    LongArray = 12
+// A Litematica region before it is merged into the schematic grid
+struct LitematicaRegion {
+    explicit LitematicaRegion(std::pmr::memory_resource* arena) : blockStates(arena) {}
+    
+    int posX = 0, posY = 0, posZ = 0;
+    int sizeX = 0, sizeY = 0, sizeZ = 0;
+    std::vector<SchematicBlock> palette;
+    std::pmr::vector<uint64_t> blockStates; // Padded with one trailing zero word for the unpacker
+    std::optional<BlockEntitySegment> tileEntities;
 };
 
-// Simple NBT parser class
-class NBTParser {
+// Everything collected while walking the root compound.
+// Temporaries live in the load's arena; names and BlockData point into the decompressed buffer.
+struct ParseState {
+    explicit ParseState(std::pmr::memory_resource* arena) : paletteMap(arena), regions(arena) {}
+    
+    Schematic schem;
+    std::pmr::unordered_map<std::string_view, int> paletteMap; // Sponge palette
+    std::span<const uint8_t> blockData;                        // Sponge VarInt block data
+    std::pmr::vector<LitematicaRegion> regions;                // Litematica regions
+    std::optional<std::span<const uint8_t>> regionsPayload;    // Litematica "Regions" compound, read afterwards
+    std::vector<BlockEntitySegment> blockEntities;             // Raw block-entity lists, decoded at paste time
+};
+
+// Block entities stay raw until a paste needs them
+static BlockEntitySegment makeBlockEntitySegment(BlockEntityFormat format, int32_t count,
+                                                 std::span<const uint8_t> payload) {
+    BlockEntitySegment segment;
+    segment.format = format;
+    segment.count = count;
+    segment.bytes.assign(payload.begin(), payload.end());
+    return segment;
+}
+
+// NbtVisitor handler for Sponge v2 (fields on the root) and v3 (nested "Schematic"
+// with a "Blocks" container). Litematica's "Regions" compound is captured for LitematicaHandler.
+class SpongeHandler {
 public:
-    NBTParser(const std::vector<uint8_t>& data) : mData(data), mPos(0) {}
+    explicit SpongeHandler(ParseState& state) : mState(state) {}
     
-    std::optional<Schematic> parseSchematic() {
-        // Read root compound tag
-        if (readByte() != static_cast<uint8_t>(TagType::Compound)) {
-            return std::nullopt;
+    void onShort(const NbtName& name, int16_t value) {
+        if (context() != Context::Root) {
+            return;
         }
-        
-        // Read root name (usually "Schematic")
-        readString();
-        
-        Schematic schem;
-        std::unordered_map<std::string, int> paletteMap;
-        std::vector<uint8_t> blockData;
-        bool inMetadata = false;
-        
-        // Parse compound contents
-        while (mPos < mData.size()) {
-            uint8_t tagType = readByte();
-            if (tagType == static_cast<uint8_t>(TagType::End)) {
-                if (inMetadata) {
-                    inMetadata = false;
-                    continue;
-                }
+        Schematic& schem = mState.schem;
+        switch (name.hash) {
+        case nbtNameHash("Width"):
+            if (name == "Width") schem.width = static_cast<uint16_t>(value);
+            break;
+        case nbtNameHash("Height"):
+            if (name == "Height") schem.height = static_cast<uint16_t>(value);
+            break;
+        case nbtNameHash("Length"):
+            if (name == "Length") schem.length = static_cast<uint16_t>(value);
+            break;
+        }
+    }
+    
+    void onInt(const NbtName& name, int32_t value) {
+        switch (context()) {
+        case Context::Palette:
+            // Key views the input buffer, which outlives the parse
+            mState.paletteMap[name.text] = value;
+            break;
+        case Context::Metadata:
+            switch (name.hash) {
+            case nbtNameHash("WEOffsetX"):
+                if (name == "WEOffsetX") mState.schem.offsetX = value;
+                break;
+            case nbtNameHash("WEOffsetY"):
+                if (name == "WEOffsetY") mState.schem.offsetY = value;
+                break;
+            case nbtNameHash("WEOffsetZ"):
+                if (name == "WEOffsetZ") mState.schem.offsetZ = value;
                 break;
             }
-            
-            std::string tagName = readString();
-            
-            // Handle specific tags for Sponge Schematic format
-            if (tagName == "Width" && tagType == static_cast<uint8_t>(TagType::Short)) {
-                schem.width = readShort();
-            }
-            else if (tagName == "Height" && tagType == static_cast<uint8_t>(TagType::Short)) {
-                schem.height = readShort();
-            }
-            else if (tagName == "Length" && tagType == static_cast<uint8_t>(TagType::Short)) {
-                schem.length = readShort();
-            }
-            else if (tagName == "Palette" && tagType == static_cast<uint8_t>(TagType::Compound)) {
-                parsePalette(paletteMap, schem);
-            }
-            else if (tagName == "BlockData" && tagType == static_cast<uint8_t>(TagType::ByteArray)) {
-                blockData = readByteArray();
-            }
-            else if (tagName == "Metadata" && tagType == static_cast<uint8_t>(TagType::Compound)) {
-                inMetadata = true;
-                // Parse metadata for offset
-                parseMetadata(schem);
-            }
-            else if (tagName == "Offset" && tagType == static_cast<uint8_t>(TagType::IntArray)) {
-                auto offset = readIntArray();
-                if (offset.size() >= 3) {
-                    schem.offsetX = offset[0];
-                    schem.offsetY = offset[1];
-                    schem.offsetZ = offset[2];
-                }
-            }
-            else {
-                // Skip unknown tags
-                skipTag(static_cast<TagType>(tagType));
-            }
+            break;
+        default:
+            break;
         }
-        
-        // Convert block data using VarInt encoding (Sponge Schematic v2)
-        if (!blockData.empty() && !paletteMap.empty()) {
-            schem.blocks = parseVarIntBlocks(blockData, schem.width, schem.height, schem.length);
+    }
+    
+    void onIntArray(const NbtName& name, NbtArrayView<int32_t> values) {
+        if (context() == Context::Root && name.hash == nbtNameHash("Offset") && name == "Offset"
+            && values.size() >= 3) {
+            mState.schem.offsetX = values[0];
+            mState.schem.offsetY = values[1];
+            mState.schem.offsetZ = values[2];
         }
-        
-        // Build palette vector from map
-        if (!paletteMap.empty()) {
-            int maxIndex = 0;
-            for (const auto& [name, idx] : paletteMap) {
-                maxIndex = std::max(maxIndex, idx);
-            }
-            schem.palette.resize(maxIndex + 1);
-            for (const auto& [name, idx] : paletteMap) {
-                schem.palette[idx] = parseBlockState(name);
+    }
+    
+    void onByteArray(const NbtName& name, std::span<const uint8_t> bytes) {
+        // v2 keeps "BlockData" on the root, v3 has "Data" inside "Blocks"
+        if ((context() == Context::Root && name.hash == nbtNameHash("BlockData") && name == "BlockData")
+            || (context() == Context::Blocks && name.hash == nbtNameHash("Data") && name == "Data")) {
+            mState.blockData = bytes;
+        }
+    }
+    
+    NbtAction beginCompound(const NbtName& name) {
+        Context next = Context::None;
+        switch (context()) {
+        case Context::Root:
+            switch (name.hash) {
+            case nbtNameHash("Palette"):
+                if (name == "Palette") next = Context::Palette;
+                break;
+            case nbtNameHash("Metadata"):
+                if (name == "Metadata") next = Context::Metadata;
+                break;
+            case nbtNameHash("Schematic"):
+                // Sponge v3 wraps everything in a "Schematic" compound
+                if (name == "Schematic") next = Context::Root;
+                break;
+            case nbtNameHash("Blocks"):
+                if (name == "Blocks") next = Context::Blocks;
+                break;
+            case nbtNameHash("Regions"):
+                if (name == "Regions") return NbtAction::Capture;
+                break;
             }
+            break;
+        case Context::Blocks:
+            if (name.hash == nbtNameHash("Palette") && name == "Palette") next = Context::Palette;
+            break;
+        default:
+            break;
         }
         
-        return schem;
+        if (next == Context::None || mDepth + 1 >= kMaxDepth) {
+            return NbtAction::Skip;
+        }
+        mContexts[++mDepth] = next;
+        return NbtAction::Enter;
     }
+    
+    void endCompound() { mDepth--; }
+    
+    NbtAction beginList(const NbtName& name, TagType elementType, int32_t count) {
+        if (elementType != TagType::Compound || count <= 0) {
+            return NbtAction::Skip;
+        }
+        bool blockEntities = (name.hash == nbtNameHash("BlockEntities") && name == "BlockEntities")
+                          || (name.hash == nbtNameHash("TileEntities") && name == "TileEntities");
+        if (blockEntities && (context() == Context::Root || context() == Context::Blocks)) {
+            return NbtAction::Capture;
+        }
+        return NbtAction::Skip;
+    }
+    
+    void onCapturedList(const NbtName&, TagType, int32_t count, std::span<const uint8_t> payload) {
+        auto format = context() == Context::Blocks ? BlockEntityFormat::SpongeV3 : BlockEntityFormat::SpongeV2;
+        mState.blockEntities.push_back(makeBlockEntitySegment(format, count, payload));
+    }
+    
+    void onCapturedCompound(const NbtName&, std::span<const uint8_t> payload) { mState.regionsPayload = payload; }
 
 private:
-    const std::vector<uint8_t>& mData;
-    size_t mPos;
+    enum class Context : uint8_t { None, Root, Palette, Metadata, Blocks };
+    static constexpr int kMaxDepth = 8; // Only known containers are entered
+    
+    Context context() const { return mContexts[mDepth]; }
+    
+    ParseState& mState;
+    Context mContexts[kMaxDepth] = {Context::Root};
+    int mDepth = 0;
+};
+
+// NbtVisitor handler for the children of Litematica's "Regions" compound: one region per
+// compound, with its Position, Size, BlockStatePalette, BlockStates and TileEntities
+class LitematicaHandler {
+public:
+    LitematicaHandler(ParseState& state, std::pmr::memory_resource* arena) : mState(state), mArena(arena) {}
     
-    uint8_t readByte() {
-        if (mPos >= mData.size()) throw std::runtime_error("NBT: Unexpected end of data");
-        return mData[mPos++];
+    // { x: int, y: int, z: int }
+    void onInt(const NbtName& name, int32_t value) {
+        if (context() != Context::Position && context() != Context::Size) {
+            return;
+        }
+        auto& region = mState.regions.back();
+        bool position = context() == Context::Position;
+        switch (name.hash) {
+        case nbtNameHash("x"):
+            if (name == "x") (position ? region.posX : region.sizeX) = value;
+            break;
+        case nbtNameHash("y"):
+            if (name == "y") (position ? region.posY : region.sizeY) = value;
+            break;
+        case nbtNameHash("z"):
+            if (name == "z") (position ? region.posZ : region.sizeZ) = value;
+            break;
+        }
     }
     
-    int16_t readShort() {
-        uint8_t b1 = readByte();
-        uint8_t b2 = readByte();
-        return static_cast<int16_t>((b1 << 8) | b2);
+    // { Name: "minecraft:stone", Properties: { key: "value", ... } }
+    void onString(const NbtName& name, std::string_view value) {
+        switch (context()) {
+        case Context::PaletteEntry:
+            if (name.hash == nbtNameHash("Name") && name == "Name") {
+                mState.regions.back().palette.back().name = std::string(value);
+            }
+            break;
+        case Context::Properties:
+            mState.regions.back().palette.back().properties[std::string(name.text)] = value;
+            break;
+        default:
+            break;
+        }
     }
     
-    int32_t readInt() {
-        uint8_t b1 = readByte();
-        uint8_t b2 = readByte();
-        uint8_t b3 = readByte();
-        uint8_t b4 = readByte();
-        return static_cast<int32_t>((b1 << 24) | (b2 << 16) | (b3 << 8) | b4);
+    void onLongArray(const NbtName& name, NbtArrayView<int64_t> values) {
+        if (context() == Context::Region && name.hash == nbtNameHash("BlockStates") && name == "BlockStates") {
+            // Padded with one extra zero word for the unpacker
+            auto& words = mState.regions.back().blockStates;
+            words.assign(values.size() + 1, 0);
+            for (size_t i = 0; i < values.size(); i++) {
+                words[i] = static_cast<uint64_t>(values[i]);
+            }
+        }
     }
     
-    int64_t readLong() {
-        int64_t result = 0;
-        for (int i = 0; i < 8; i++) {
-            result = (result << 8) | readByte();
+    NbtAction beginCompound(const NbtName& name) {
+        Context next = Context::None;
+        switch (context()) {
+        case Context::Regions:
+            // Any name: every compound here is a region
+            mState.regions.emplace_back(mArena);
+            next = Context::Region;
+            break;
+        case Context::Region:
+            switch (name.hash) {
+            case nbtNameHash("Position"):
+                if (name == "Position") next = Context::Position;
+                break;
+            case nbtNameHash("Size"):
+                if (name == "Size") next = Context::Size;
+                break;
+            }
+            break;
+        case Context::Palette:
+            mState.regions.back().palette.emplace_back();
+            next = Context::PaletteEntry;
+            break;
+        case Context::PaletteEntry:
+            if (name.hash == nbtNameHash("Properties") && name == "Properties") next = Context::Properties;
+            break;
+        default:
+            break;
         }
-        return result;
+        return enter(next);
     }
     
-    float readFloat() {
-        int32_t bits = readInt();
-        float result;
-        std::memcpy(&result, &bits, sizeof(float));
-        return result;
+    void endCompound() { mDepth--; }
+    
+    NbtAction beginList(const NbtName& name, TagType elementType, int32_t count) {
+        if (context() != Context::Region || elementType != TagType::Compound || count <= 0) {
+            return NbtAction::Skip;
+        }
+        switch (name.hash) {
+        case nbtNameHash("BlockStatePalette"):
+            if (name == "BlockStatePalette") return enter(Context::Palette);
+            break;
+        case nbtNameHash("TileEntities"):
+            if (name == "TileEntities") return NbtAction::Capture;
+            break;
+        }
+        return NbtAction::Skip;
     }
     
-    double readDouble() {
-        int64_t bits = readLong();
-        double result;
-        std::memcpy(&result, &bits, sizeof(double));
-        return result;
+    void endList() { mDepth--; }
+    
+    void onCapturedList(const NbtName&, TagType, int32_t count, std::span<const uint8_t> payload) {
+        mState.regions.back().tileEntities = makeBlockEntitySegment(BlockEntityFormat::Litematica, count, payload);
     }
+
+private:
+    enum class Context : uint8_t { None, Regions, Region, Position, Size, Palette, PaletteEntry, Properties };
+    static constexpr int kMaxDepth = 8; // Only known containers are entered
     
-    std::string readString() {
-        int16_t length = readShort();
-        if (length < 0 || mPos + length > mData.size()) {
-            throw std::runtime_error("NBT: Invalid string length");
+    Context context() const { return mContexts[mDepth]; }
+    
+    NbtAction enter(Context next) {
+        if (next == Context::None || mDepth + 1 >= kMaxDepth) {
+            return NbtAction::Skip;
         }
-        std::string result(reinterpret_cast<const char*>(&mData[mPos]), length);
-        mPos += length;
-        return result;
+        mContexts[++mDepth] = next;
+        return NbtAction::Enter;
     }
     
-    std::vector<uint8_t> readByteArray() {
-        int32_t length = readInt();
-        if (length < 0 || mPos + length > mData.size()) {
-            throw std::runtime_error("NBT: Invalid byte array length");
+    ParseState& mState;
+    std::pmr::memory_resource* mArena;
+    Context mContexts[kMaxDepth] = {Context::Regions};
+    int mDepth = 0;
+};
+
+// Runs the format handlers over the root compound and assembles the schematic
+class NBTParser {
+public:
+    // headerOnly: `data` is a stream skeleton whose block arrays are empty, leave `blocks` unset
+    NBTParser(const std::vector<uint8_t>& data, std::pmr::memory_resource* arena, bool headerOnly = false)
+    : mData(data),
+      mArena(arena),
+      mHeaderOnly(headerOnly) {}
+    
+    std::optional<Schematic> parseSchematic() {
+        ParseState state(mArena);
+        
+        SpongeHandler handler(state);
+        NbtVisitor<SpongeHandler> visitor(mData.data(), mData.size(), handler);
+        {
+            WA_TRACE_ZONE("walk NBT");
+            if (!visitor.visitRoot()) {
+                return std::nullopt;
+            }
+        }
+        
+        if (state.regionsPayload) {
+            WA_TRACE_ZONE("walk litematica regions");
+            LitematicaHandler regionHandler(state, mArena);
+            NbtVisitor<LitematicaHandler> regionVisitor(state.regionsPayload->data(), state.regionsPayload->size(),
+                                                        regionHandler);
+            regionVisitor.visitCompoundBody();
+        }
+        
+        if (!state.regions.empty()) {
+            mergeLitematicaRegions(state);
+            attachBlockEntities(state);
+            return std::move(state.schem);
+        }
+        
+        Schematic& schem = state.schem;
+        
+        // Convert block data using VarInt encoding (Sponge Schematic v2/v3)
+        if (!state.blockData.empty() && !state.paletteMap.empty()) {
+            auto grid = parseVarIntBlocks(state.blockData, schem.width, schem.height, schem.length);
+            schem.blocks = SectionedBlocks::fromGrid(grid.data(), grid.size(), schem.width, schem.height,
+                                                     schem.length, true);
+        }
+        
+        // Build palette vector from map
+        if (!state.paletteMap.empty()) {
+            WA_TRACE_ZONE("parse block states");
+            int maxIndex = 0;
+            for (const auto& [name, idx] : state.paletteMap) {
+                maxIndex = std::max(maxIndex, idx);
+            }
+            schem.palette.resize(maxIndex + 1);
+            for (const auto& [name, idx] : state.paletteMap) {
+                schem.palette[idx] = parseBlockState(name);
+            }
         }
-        std::vector<uint8_t> result(mData.begin() + mPos, mData.begin() + mPos + length);
-        mPos += length;
-        return result;
+        
+        attachBlockEntities(state);
+        return std::move(state.schem);
     }
+
+private:
+    const std::vector<uint8_t>& mData;
+    std::pmr::memory_resource* mArena;
+    bool mHeaderOnly;
     
-    std::vector<int32_t> readIntArray() {
-        int32_t length = readInt();
-        if (length < 0) {
-            throw std::runtime_error("NBT: Invalid int array length");
+    static void attachBlockEntities(ParseState& state) {
+        if (state.blockEntities.empty()) {
+            return;
         }
-        std::vector<int32_t> result;
-        result.reserve(length);
-        for (int32_t i = 0; i < length; i++) {
-            result.push_back(readInt());
+        WA_TRACE_ZONE("index block entities");
+        auto store = std::make_shared<BlockEntityStore>();
+        for (auto& segment : state.blockEntities) {
+            store->addSegment(std::move(segment));
         }
-        return result;
+        state.schem.blockEntities = std::move(store);
     }
     
-    void skipTag(TagType type) {
-        switch (type) {
-            case TagType::End: break;
-            case TagType::Byte: mPos++; break;
-            case TagType::Short: mPos += 2; break;
-            case TagType::Int: mPos += 4; break;
-            case TagType::Long: mPos += 8; break;
-            case TagType::Float: mPos += 4; break;
-            case TagType::Double: mPos += 8; break;
-            case TagType::ByteArray: {
-                int32_t len = readInt();
-                mPos += len;
-                break;
+    // Place all regions into one grid; negative sizes extend from Position towards -inf
+    void mergeLitematicaRegions(ParseState& state) {
+        WA_TRACE_ZONE("merge regions");
+        Schematic& schem = state.schem;
+        
+        int minX = INT_MAX, minY = INT_MAX, minZ = INT_MAX;
+        int maxX = INT_MIN, maxY = INT_MIN, maxZ = INT_MIN;
+        for (const auto& region : state.regions) {
+            int rx = region.posX + (region.sizeX < 0 ? region.sizeX + 1 : 0);
+            int ry = region.posY + (region.sizeY < 0 ? region.sizeY + 1 : 0);
+            int rz = region.posZ + (region.sizeZ < 0 ? region.sizeZ + 1 : 0);
+            minX = std::min(minX, rx);
+            minY = std::min(minY, ry);
+            minZ = std::min(minZ, rz);
+            maxX = std::max(maxX, rx + std::abs(region.sizeX));
+            maxY = std::max(maxY, ry + std::abs(region.sizeY));
+            maxZ = std::max(maxZ, rz + std::abs(region.sizeZ));
+        }
+        
+        schem.width = maxX - minX;
+        schem.height = maxY - minY;
+        schem.length = maxZ - minZ;
+        // Region positions are relative to the Litematica origin
+        schem.offsetX = minX;
+        schem.offsetY = minY;
+        schem.offsetZ = minZ;
+        
+        size_t volume = schem.getBlockCount();
+        if (mHeaderOnly && state.regions.size() > 1) {
+            throw std::runtime_error("Litematica: only single-region files can be streamed");
+        }
+        if (!mHeaderOnly && volume > static_cast<size_t>(INT_MAX)) {
+            throw std::runtime_error("Litematica: schematic too large");
+        }
+        
+        // Tile entity positions are relative to their region's minimum corner
+        for (auto& region : state.regions) {
+            if (!region.tileEntities) {
+                continue;
             }
-            case TagType::String: {
-                int16_t len = readShort();
-                mPos += len;
-                break;
+            region.tileEntities->originX = region.posX + (region.sizeX < 0 ? region.sizeX + 1 : 0) - minX;
+            region.tileEntities->originY = region.posY + (region.sizeY < 0 ? region.sizeY + 1 : 0) - minY;
+            region.tileEntities->originZ = region.posZ + (region.sizeZ < 0 ? region.sizeZ + 1 : 0) - minZ;
+            state.blockEntities.push_back(std::move(*region.tileEntities));
+        }
+        
+        // Single region: unpack straight into the block array
+        if (state.regions.size() == 1) {
+            auto& region = state.regions.front();
+            schem.palette = std::move(region.palette);
+            if (mHeaderOnly) {
+                return;
             }
-            case TagType::List: {
-                uint8_t elemType = readByte();
-                int32_t len = readInt();
-                for (int32_t i = 0; i < len; i++) {
-                    skipTag(static_cast<TagType>(elemType));
+            std::vector<int> grid(volume, 0);
+            unpackRegion(region, schem.palette.size(), grid.data(), volume);
+            schem.blocks = SectionedBlocks::fromGrid(grid.data(), volume, schem.width, schem.height, schem.length,
+                                                     true);
+            return;
+        }
+        
+        // Multiple regions: shared palette with air at index 0
+        std::pmr::unordered_map<std::pmr::string, int> globalPalette(mArena);
+        schem.palette.push_back(SchematicBlock{"minecraft:air", {}});
+        globalPalette.emplace(std::pmr::string("minecraft:air", mArena), 0);
+        std::vector<int> grid(volume, 0);
+        
+        std::pmr::vector<int> local(mArena);
+        std::pmr::vector<int> remap(mArena);
+        std::pmr::string key(mArena);
+        for (const auto& region : state.regions) {
+            remap.assign(region.palette.size(), 0);
+            for (size_t i = 0; i < region.palette.size(); i++) {
+                appendBlockKey(key, region.palette[i]);
+                auto [it, inserted] = globalPalette.emplace(key, static_cast<int>(schem.palette.size()));
+                if (inserted) {
+                    schem.palette.push_back(region.palette[i]);
                 }
-                break;
+                remap[i] = it->second;
             }
-            case TagType::Compound: {
-                while (true) {
-                    uint8_t subType = readByte();
-                    if (subType == static_cast<uint8_t>(TagType::End)) break;
-                    readString(); // name
-                    skipTag(static_cast<TagType>(subType));
+            
+            int sx = std::abs(region.sizeX);
+            int sy = std::abs(region.sizeY);
+            int sz = std::abs(region.sizeZ);
+            size_t regionVolume = static_cast<size_t>(sx) * sy * sz;
+            local.assign(regionVolume, 0);
+            unpackRegion(region, region.palette.size(), local.data(), regionVolume);
+            
+            int rx = region.posX + (region.sizeX < 0 ? region.sizeX + 1 : 0) - minX;
+            int ry = region.posY + (region.sizeY < 0 ? region.sizeY + 1 : 0) - minY;
+            int rz = region.posZ + (region.sizeZ < 0 ? region.sizeZ + 1 : 0) - minZ;
+            
+            size_t src = 0;
+            for (int y = 0; y < sy; y++) {
+                for (int z = 0; z < sz; z++) {
+                    size_t dst = (static_cast<size_t>(ry + y) * schem.length + (rz + z)) * schem.width + rx;
+                    for (int x = 0; x < sx; x++, src++) {
+                        int value = local[src];
+                        if (value < 0 || static_cast<size_t>(value) >= remap.size()) {
+                            continue;
+                        }
+                        // Later regions only overwrite with non-air
+                        if (remap[value] != 0) {
+                            grid[dst + x] = remap[value];
+                        }
+                    }
                 }
-                break;
-            }
-            case TagType::IntArray: {
-                int32_t len = readInt();
-                mPos += len * 4;
-                break;
-            }
-            case TagType::LongArray: {
-                int32_t len = readInt();
-                mPos += len * 8;
-                break;
             }
         }
+        
+        schem.blocks = SectionedBlocks::fromGrid(grid.data(), volume, schem.width, schem.height, schem.length, true);
     }
     
-    void parsePalette(std::unordered_map<std::string, int>& paletteMap, Schematic& schem) {
-        while (true) {
-            uint8_t tagType = readByte();
-            if (tagType == static_cast<uint8_t>(TagType::End)) break;
-            
-            std::string blockName = readString();
-            if (tagType == static_cast<uint8_t>(TagType::Int)) {
-                int index = readInt();
-                paletteMap[blockName] = index;
-            } else {
-                skipTag(static_cast<TagType>(tagType));
+    // Same text as SchematicBlock::toString, built into a reused arena string
+    static void appendBlockKey(std::pmr::string& key, const SchematicBlock& block) {
+        key.assign(block.name);
+        if (block.properties.empty()) {
+            return;
+        }
+        key.push_back('[');
+        bool first = true;
+        for (const auto& [name, value] : block.properties) {
+            if (!first) {
+                key.push_back(',');
             }
+            key.append(name).push_back('=');
+            key.append(value);
+            first = false;
         }
+        key.push_back(']');
     }
     
-    void parseMetadata(Schematic& schem) {
-        while (true) {
-            uint8_t tagType = readByte();
-            if (tagType == static_cast<uint8_t>(TagType::End)) break;
-            
-            std::string tagName = readString();
-            if (tagName == "WEOffsetX" && tagType == static_cast<uint8_t>(TagType::Int)) {
-                schem.offsetX = readInt();
-            } else if (tagName == "WEOffsetY" && tagType == static_cast<uint8_t>(TagType::Int)) {
-                schem.offsetY = readInt();
-            } else if (tagName == "WEOffsetZ" && tagType == static_cast<uint8_t>(TagType::Int)) {
-                schem.offsetZ = readInt();
-            } else {
-                skipTag(static_cast<TagType>(tagType));
-            }
+    static void unpackRegion(const LitematicaRegion& region, size_t paletteSize, int* out, size_t count) {
+        if (region.blockStates.size() < 2 || paletteSize == 0) {
+            return;
         }
+        WA_TRACE_ZONE("bit unpack");
+        int bits = litematicaBitsPerEntry(paletteSize);
+        size_t wordCount = region.blockStates.size() - 1; // Last word is padding
+        unpackBitArray(region.blockStates.data(), wordCount, bits, count, out);
     }
     
-    std::vector<int> parseVarIntBlocks(const std::vector<uint8_t>& data, int width, int height, int length) {
+    std::vector<int> parseVarIntBlocks(std::span<const uint8_t> data, int width, int height, int length) {
+        WA_TRACE_ZONE("varint decode");
         std::vector<int> blocks;
         size_t expectedSize = static_cast<size_t>(width) * height * length;
         blocks.reserve(expectedSize);
@@ -295,12 +557,13 @@ private:
         return blocks;
     }
     
-    SchematicBlock parseBlockState(const std::string& blockString) {
+    // Pieces are views into the palette key; only the final name and properties allocate
+    SchematicBlock parseBlockState(std::string_view blockString) {
         SchematicBlock block;
         
         // Parse format: "minecraft:stone[facing=north,half=top]"
         size_t bracketStart = blockString.find('[');
-        if (bracketStart == std::string::npos) {
+        if (bracketStart == std::string_view::npos) {
             block.name = blockString;
             return block;
         }
@@ -308,25 +571,25 @@ private:
         block.name = blockString.substr(0, bracketStart);
         
         size_t bracketEnd = blockString.find(']', bracketStart);
-        if (bracketEnd == std::string::npos) {
+        if (bracketEnd == std::string_view::npos) {
             return block;
         }
         
-        std::string propsStr = blockString.substr(bracketStart + 1, bracketEnd - bracketStart - 1);
+        std::string_view propsStr = blockString.substr(bracketStart + 1, bracketEnd - bracketStart - 1);
         
         // Parse properties
         size_t start = 0;
         while (start < propsStr.size()) {
             size_t equalPos = propsStr.find('=', start);
-            if (equalPos == std::string::npos) break;
+            if (equalPos == std::string_view::npos) break;
             
             size_t commaPos = propsStr.find(',', equalPos);
-            if (commaPos == std::string::npos) commaPos = propsStr.size();
+            if (commaPos == std::string_view::npos) commaPos = propsStr.size();
             
-            std::string key = propsStr.substr(start, equalPos - start);
-            std::string value = propsStr.substr(equalPos + 1, commaPos - equalPos - 1);
+            std::string_view key = propsStr.substr(start, equalPos - start);
+            std::string_view value = propsStr.substr(equalPos + 1, commaPos - equalPos - 1);
             
-            block.properties[key] = value;
+            block.properties.insert_or_assign(std::string(key), std::string(value));
             start = commaPos + 1;
         }
         
@@ -335,6 +598,7 @@ private:
 };
 
 std::vector<uint8_t> SchematicReader::readFile(const std::string& filePath) {
+    WA_TRACE_ZONE("read file");
     std::ifstream file(filePath, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         return {};
@@ -352,6 +616,7 @@ std::vector<uint8_t> SchematicReader::readFile(const std::string& filePath) {
 }
 
 std::vector<uint8_t> SchematicReader::decompressGzip(const std::vector<uint8_t>& compressed) {
+    WA_TRACE_ZONE("inflate");
     if (compressed.size() < 2) {
         return {};
     }
@@ -399,53 +664,287 @@ std::vector<uint8_t> SchematicReader::decompressGzip(const std::vector<uint8_t>&
     return decompressed;
 }
 
-std::optional<Schematic> SchematicReader::parseNBT(const std::vector<uint8_t>& data) {
+// Heap bytes of a string beyond the object itself (zero while it fits the small buffer)
+static size_t getStringHeapSize(const std::string& value) {
+    return value.capacity() > std::string().capacity() ? value.capacity() + 1 : 0;
+}
+
+size_t Schematic::getMemoryUsage() const {
+    size_t total = sizeof(Schematic);
+    total += blocks.getMemoryUsage();
+    total += palette.capacity() * sizeof(SchematicBlock);
+    
+    for (const auto& block : palette) {
+        total += getStringHeapSize(block.name);
+        // Node: key/value pair, next pointer and cached hash; plus the bucket array
+        total += block.properties.size() * (sizeof(std::pair<const std::string, std::string>) + 2 * sizeof(void*));
+        total += block.properties.bucket_count() * sizeof(void*);
+        for (const auto& [key, value] : block.properties) {
+            total += getStringHeapSize(key) + getStringHeapSize(value);
+        }
+    }
+    
+    if (blockEntities) {
+        total += sizeof(BlockEntityStore) + blockEntities->getMemoryUsage();
+    }
+    if (stream) {
+        total += sizeof(SchematicStreamSource) + getStringHeapSize(stream->path);
+    }
+    total += occupancy.layers.capacity() * sizeof(uint32_t) + occupancy.columns.capacity() * sizeof(uint16_t);
+    return total;
+}
+
+SchematicOccupancy computeOccupancy(const Schematic& schem) {
+    SchematicOccupancy occupancy;
+    if (schem.width <= 0 || schem.height <= 0 || schem.length <= 0 || schem.blocks.empty()) {
+        return occupancy;
+    }
+    WA_TRACE_ZONE("occupancy");
+    occupancy.known = true;
+    occupancy.layers.assign(schem.height, 0);
+    occupancy.columns.assign(static_cast<size_t>(schem.width) * schem.length, 0);
+    
+    std::vector<uint8_t> solid(schem.palette.size());
+    for (size_t i = 0; i < schem.palette.size(); i++) {
+        solid[i] = schem.palette[i].isAir() ? 0 : 1;
+    }
+    auto isSolid = [&](int value) {
+        return value >= 0 && static_cast<size_t>(value) < solid.size() && solid[value];
+    };
+    
+    // One worker per row of section columns: it owns those columns outright and keeps its own layer counts
+    constexpr int kSize = SectionedBlocks::kSize;
+    const auto& blocks = schem.blocks;
+    int rows = blocks.getSectionsZ();
+    std::vector<std::vector<uint32_t>> rowLayers(rows);
+    WorkerPool::getInstance().parallelFor(rows, [&](size_t row) {
+        WA_TRACE_ZONE("occupancy row");
+        auto& layers = rowLayers[row];
+        layers.assign(schem.height, 0);
+        int sectionZ = static_cast<int>(row);
+        int beginZ = sectionZ * kSize, endZ = std::min(schem.length, beginZ + kSize);
+        int values[SectionedBlocks::kVolume];
+        
+        for (int sectionX = 0; sectionX < blocks.getSectionsX(); sectionX++) {
+            int beginX = sectionX * kSize, endX = std::min(schem.width, beginX + kSize);
+            for (int sectionY = 0; sectionY < blocks.getSectionsY(); sectionY++) {
+                int beginY = sectionY * kSize, endY = std::min(schem.height, beginY + kSize);
+                size_t index = blocks.getSectionIndex(sectionX, sectionY, sectionZ);
+                const auto& section = blocks.getSection(index);
+                
+                if (section.kind == SectionedBlocks::Kind::Uniform) {
+                    if (!isSolid(section.value)) {
+                        continue;
+                    }
+                    uint32_t perLayer = static_cast<uint32_t>((endX - beginX) * (endZ - beginZ));
+                    for (int y = beginY; y < endY; y++) {
+                        layers[y] += perLayer;
+                    }
+                    for (int z = beginZ; z < endZ; z++) {
+                        for (int x = beginX; x < endX; x++) {
+                            auto& column = occupancy.columns[static_cast<size_t>(z) * schem.width + x];
+                            column = static_cast<uint16_t>(std::min<int>(UINT16_MAX, column + (endY - beginY)));
+                        }
+                    }
+                    continue;
+                }
+                
+                blocks.decode(index, values);
+                for (int y = beginY; y < endY; y++) {
+                    for (int z = beginZ; z < endZ; z++) {
+                        const int* source = values + ((y - beginY) * kSize + (z - beginZ)) * kSize;
+                        auto* columns = &occupancy.columns[static_cast<size_t>(z) * schem.width];
+                        for (int x = beginX; x < endX; x++) {
+                            if (isSolid(source[x - beginX])) {
+                                layers[y]++;
+                                if (columns[x] < UINT16_MAX) {
+                                    columns[x]++;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+    
+    for (const auto& layers : rowLayers) {
+        for (int y = 0; y < schem.height; y++) {
+            occupancy.layers[y] += layers[y];
+        }
+    }
+    
+    int minX = INT_MAX, maxX = -1, minZ = INT_MAX, maxZ = -1;
+    for (int z = 0; z < schem.length; z++) {
+        const auto* columns = &occupancy.columns[static_cast<size_t>(z) * schem.width];
+        for (int x = 0; x < schem.width; x++) {
+            if (columns[x] > 0) {
+                occupancy.footprint++;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minZ = std::min(minZ, z);
+                maxZ = std::max(maxZ, z);
+            }
+        }
+    }
+    int minY = INT_MAX, maxY = -1;
+    for (int y = 0; y < schem.height; y++) {
+        if (occupancy.layers[y] > 0) {
+            occupancy.blocks += occupancy.layers[y];
+            minY = std::min(minY, y);
+            maxY = y;
+        }
+    }
+    if (maxY >= 0) {
+        occupancy.minX = minX;
+        occupancy.minY = minY;
+        occupancy.minZ = minZ;
+        occupancy.maxX = maxX + 1;
+        occupancy.maxY = maxY + 1;
+        occupancy.maxZ = maxZ + 1;
+    }
+    return occupancy;
+}
+
+std::optional<Schematic> SchematicReader::parseNBT(const std::vector<uint8_t>& data, ParseStats& stats) {
     if (data.empty()) {
         return std::nullopt;
     }
     
+    WA_TRACE_ZONE("parse NBT");
+    
+    // Temporaries for this load only; released together when the arena goes out of scope
+    ParseArena arena(std::clamp<size_t>(data.size() / 8, 64 * 1024, 64 * 1024 * 1024));
+    
+    std::optional<Schematic> result;
     try {
-        NBTParser parser(data);
-        return parser.parseSchematic();
+        NBTParser parser(data, arena.get());
+        result = parser.parseSchematic();
     } catch (const std::exception& e) {
-        WoodenAxeMod::getInstance().getSelf().getLogger().error("NBT parse error: {}", e.what());
-        return std::nullopt;
+        Log::error("NBT parse error: {}", e.what());
     }
+    
+    stats = arena.getStats();
+    return result;
 }
 
-std::optional<Schematic> SchematicReader::loadFromFile(const std::string& filePath) {
-    auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+std::optional<Schematic> SchematicReader::loadFromFile(const std::string& filePath, ParseStats* stats) {
+    TraceCapture capture("load " + std::filesystem::path(filePath).filename().string());
+    WA_TRACE_ZONE("load schematic");
     
-    logger.debug("Loading schematic from: {}", filePath);
+    Log::debug("Loading schematic from: {}", filePath);
     
     // Read file
     auto compressed = readFile(filePath);
     if (compressed.empty()) {
-        logger.error("Failed to read file: {}", filePath);
+        Log::error("Failed to read file: {}", filePath);
         return std::nullopt;
     }
     
-    logger.debug("Read {} bytes", compressed.size());
+    Log::debug("Read {} bytes", compressed.size());
     
     // Decompress
     auto decompressed = decompressGzip(compressed);
     if (decompressed.empty()) {
-        logger.error("Failed to decompress file");
+        Log::error("Failed to decompress file");
         return std::nullopt;
     }
     
-    logger.debug("Decompressed to {} bytes", decompressed.size());
+    Log::debug("Decompressed to {} bytes", decompressed.size());
     
     // Parse NBT
-    auto schem = parseNBT(decompressed);
+    ParseStats localStats;
+    auto& parseStats = stats ? *stats : localStats;
+    auto parseStart = std::chrono::steady_clock::now();
+    auto schem = parseNBT(decompressed, parseStats);
+    parseStats.parseMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - parseStart).count();
     if (!schem) {
-        logger.error("Failed to parse NBT data");
+        Log::error("Failed to parse NBT data");
+        return std::nullopt;
+    }
+    
+    Log::debug("Parsed NBT in {:.2f} ms (vectorized unpack: {})", parseStats.parseMs, hasVectorizedUnpack());
+    Log::debug("Parse arena: {} allocations ({} bytes) in {} heap blocks ({} bytes)",
+               parseStats.arenaAllocations, parseStats.arenaBytes,
+               parseStats.upstreamBlocks, parseStats.upstreamBytes);
+    
+    Log::info("Loaded schematic: {}x{}x{} ({} blocks, {} palette entries)",
+              schem->width, schem->height, schem->length,
+              schem->getBlockCount(), schem->palette.size());
+    Log::debug("Block sections: {} ({} distinct stored) in {} KB ({} KB expanded)",
+               schem->blocks.getSectionCount(), schem->blocks.getStoredSectionCount(),
+               schem->blocks.getMemoryUsage() / 1024, schem->getBlockCount() * sizeof(int) / 1024);
+    
+    schem->occupancy = computeOccupancy(*schem);
+    const auto& occupancy = schem->occupancy;
+    Log::debug("Content: {} blocks in {}x{}x{} from ({}, {}, {}), {} columns",
+               occupancy.blocks, occupancy.getSizeX(), occupancy.getSizeY(), occupancy.getSizeZ(),
+               occupancy.minX, occupancy.minY, occupancy.minZ, occupancy.footprint);
+    
+    return schem;
+}
+
+std::optional<Schematic> SchematicReader::loadHeaderFromFile(const std::string& filePath) {
+    
+    Log::debug("Loading schematic header from: {}", filePath);
+    auto start = std::chrono::steady_clock::now();
+    
+    // One pass over the stream: everything but the voxel arrays is copied out
+    std::vector<uint8_t> skeleton;
+    std::vector<StreamedArray> arrays;
+    try {
+        InflateReader reader;
+        if (!reader.open(filePath)) {
+            Log::error("Failed to read file: {}", filePath);
+            return std::nullopt;
+        }
+        buildStreamSkeleton(reader, skeleton, arrays);
+    } catch (const std::exception& e) {
+        Log::error("Failed to scan {}: {}", filePath, e.what());
+        return std::nullopt;
+    }
+    
+    std::optional<Schematic> schem;
+    ParseArena arena(std::clamp<size_t>(skeleton.size() / 8, 64 * 1024, 64 * 1024 * 1024));
+    try {
+        NBTParser parser(skeleton, arena.get(), true);
+        schem = parser.parseSchematic();
+    } catch (const std::exception& e) {
+        Log::error("NBT parse error: {}", e.what());
+    }
+    if (!schem) {
+        Log::error("Failed to parse NBT data");
+        return std::nullopt;
+    }
+    
+    auto source = std::make_shared<SchematicStreamSource>();
+    source->path = filePath;
+    bool found = false;
+    for (const auto& array : arrays) {
+        if (array.longs && array.path.starts_with("Regions/") && array.path.ends_with("/BlockStates")) {
+            source->encoding = StreamEncoding::PackedLongs;
+            source->bits = litematicaBitsPerEntry(schem->palette.size());
+        } else if (!array.longs && (array.path == "BlockData" || array.path.ends_with("Blocks/Data"))) {
+            source->encoding = StreamEncoding::VarInt;
+        } else {
+            continue;
+        }
+        source->dataOffset = array.offset;
+        source->dataCount = array.count;
+        found = true;
+        break;
+    }
+    if (!found || schem->palette.empty()) {
+        Log::error("No block data in {}", filePath);
         return std::nullopt;
     }
+    schem->stream = std::move(source);
     
-    logger.info("Loaded schematic: {}x{}x{} ({} blocks, {} palette entries)",
-                schem->width, schem->height, schem->length,
-                schem->blocks.size(), schem->palette.size());
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    Log::info("Loaded schematic header: {}x{}x{} ({} blocks streamed, {} palette entries, {:.2f} ms)",
+              schem->width, schem->height, schem->length,
+              schem->getBlockCount(), schem->palette.size(), elapsed);
     
     return schem;
 }
@@ -460,14 +959,13 @@ std::vector<std::string> SchematicReader::listSchematics(const std::string& dire
                 // Convert to lowercase for comparison
                 for (auto& c : ext) c = static_cast<char>(std::tolower(c));
                 
-                if (ext == ".schem" || ext == ".schematic") {
+                if (ext == ".schem" || ext == ".schematic" || ext == ".litematic") {
                     result.push_back(entry.path().filename().string());
                 }
             }
         }
     } catch (const std::exception& e) {
-        WoodenAxeMod::getInstance().getSelf().getLogger().error(
-            "Error listing schematics: {}", e.what());
+        Log::error("Error listing schematics: {}", e.what());
     }
     
     return result;
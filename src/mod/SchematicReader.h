@@ -1,5 +1,8 @@
 #pragma once
 
+#include "mod/BlockEntities.h"
+#include "mod/SectionedBlocks.h"
+
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -9,11 +12,19 @@
 
 namespace wooden_axe {
 
+struct ParseStats;
+struct SchematicStreamSource;
+
 // Simple block state representation
 struct SchematicBlock {
     std::string name;  // e.g. "minecraft:stone"
     std::unordered_map<std::string, std::string> properties;  // Block states
     
+    // Any Java air variant; never written by a paste
+    bool isAir() const {
+        return name == "minecraft:air" || name == "air" || name == "minecraft:cave_air" || name == "minecraft:void_air";
+    }
+    
     std::string toString() const {
         if (properties.empty()) {
             return name;
@@ -30,6 +41,25 @@ struct SchematicBlock {
     }
 };
 
+// Where the non-air voxels of a schematic are, computed once its blocks are in memory.
+// Streamed schematics leave it unknown.
+struct SchematicOccupancy {
+    bool known = false;
+    
+    // Tight box around every non-air voxel, schematic-local [min, max); all zero if there are none
+    int minX = 0, minY = 0, minZ = 0;
+    int maxX = 0, maxY = 0, maxZ = 0;
+    
+    size_t blocks = 0;    // Non-air voxels
+    size_t footprint = 0; // X/Z columns holding at least one
+    std::vector<uint32_t> layers;  // Non-air voxels per Y layer
+    std::vector<uint16_t> columns; // Non-air voxels per column (z * width + x), saturating
+    
+    int getSizeX() const { return maxX - minX; }
+    int getSizeY() const { return maxY - minY; }
+    int getSizeZ() const { return maxZ - minZ; }
+};
+
 // Schematic data structure
 struct Schematic {
     int width = 0;
@@ -44,20 +74,27 @@ struct Schematic {
     // Block palette: index -> block
     std::vector<SchematicBlock> palette;
     
-    // Block data: 3D array stored as 1D (index = y * width * length + z * width + x)
-    std::vector<int> blocks;
+    // Block data: palette indices in 16x16x16 sections (uniform ones as a single value)
+    SectionedBlocks blocks;
+    
+    // Non-air bounding box and per-layer/per-column counts
+    SchematicOccupancy occupancy;
+    
+    // Chests, signs, spawners... kept as raw NBT until a paste needs them
+    std::shared_ptr<const BlockEntityStore> blockEntities;
+    
+    // Set when only the header was loaded: `blocks` is empty and the block array
+    // is decoded from the file window by window at paste time
+    std::shared_ptr<const SchematicStreamSource> stream;
     
     // Get block at position
     std::optional<SchematicBlock> getBlock(int x, int y, int z) const {
         if (x < 0 || x >= width || y < 0 || y >= height || z < 0 || z >= length) {
             return std::nullopt;
         }
-        int index = y * width * length + z * width + x;
-        if (index >= 0 && static_cast<size_t>(index) < blocks.size()) {
-            int paletteIndex = blocks[index];
-            if (paletteIndex >= 0 && static_cast<size_t>(paletteIndex) < palette.size()) {
-                return palette[paletteIndex];
-            }
+        int paletteIndex = blocks.get(x, y, z);
+        if (paletteIndex >= 0 && static_cast<size_t>(paletteIndex) < palette.size()) {
+            return palette[paletteIndex];
         }
         return std::nullopt;
     }
@@ -66,19 +103,29 @@ struct Schematic {
     size_t getBlockCount() const {
         return static_cast<size_t>(width) * height * length;
     }
+    
+    // Bytes held in memory: block sections, palette entries with their strings, block entities
+    size_t getMemoryUsage() const;
 };
 
+// Count non-air voxels per layer and per column, and bound them (worker pool)
+SchematicOccupancy computeOccupancy(const Schematic& schem);
+
 class SchematicReader {
 public:
-    // Load schematic from file
-    static std::optional<Schematic> loadFromFile(const std::string& filePath);
+    // Load schematic from file; stats (optional) receives parse time and arena allocation counts
+    static std::optional<Schematic> loadFromFile(const std::string& filePath, ParseStats* stats = nullptr);
+    
+    // Load everything except the block array, which is streamed from the file when pasted.
+    // Memory use does not depend on the schematic's volume.
+    static std::optional<Schematic> loadHeaderFromFile(const std::string& filePath);
     
     // List available schematics in directory
     static std::vector<std::string> listSchematics(const std::string& directory);
 
 private:
     // Parse NBT data from uncompressed bytes
-    static std::optional<Schematic> parseNBT(const std::vector<uint8_t>& data);
+    static std::optional<Schematic> parseNBT(const std::vector<uint8_t>& data, ParseStats& stats);
     
     // Decompress gzip data
     static std::vector<uint8_t> decompressGzip(const std::vector<uint8_t>& compressed);
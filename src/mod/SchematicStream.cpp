@@ -0,0 +1,428 @@
+#include "mod/SchematicStream.h"
+#include "mod/Nbt.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace wooden_axe {
+
+InflateReader::~InflateReader() {
+    if (mInflateReady) {
+        inflateEnd(&mStream);
+    }
+}
+
+bool InflateReader::open(const std::string& path) {
+    mFile.open(path, std::ios::binary);
+    if (!mFile.is_open()) {
+        return false;
+    }
+
+    mIn.resize(kBufferSize);
+    mOut.resize(kBufferSize);
+
+    // Same rule as SchematicReader::decompressGzip: no gzip magic means uncompressed NBT
+    uint8_t magic[2] = {0, 0};
+    mFile.read(reinterpret_cast<char*>(magic), 2);
+    size_t got = static_cast<size_t>(mFile.gcount());
+    mGzip = got == 2 && magic[0] == 0x1F && magic[1] == 0x8B;
+
+    if (!mGzip) {
+        std::memcpy(mOut.data(), magic, got);
+        mOutEnd = got;
+        return true;
+    }
+
+    // 15 + 16 for gzip format
+    if (inflateInit2(&mStream, 15 + 16) != Z_OK) {
+        return false;
+    }
+    mInflateReady = true;
+    mIn[0] = magic[0];
+    mIn[1] = magic[1];
+    mStream.next_in = mIn.data();
+    mStream.avail_in = 2;
+    return true;
+}
+
+void InflateReader::refill() {
+    mOutPos = 0;
+    mOutEnd = 0;
+
+    if (!mGzip) {
+        mFile.read(reinterpret_cast<char*>(mOut.data()), static_cast<std::streamsize>(mOut.size()));
+        mOutEnd = static_cast<size_t>(mFile.gcount());
+        if (mOutEnd == 0) {
+            throw std::runtime_error("NBT: Unexpected end of data");
+        }
+        return;
+    }
+
+    while (mOutEnd == 0) {
+        if (mEnd) {
+            throw std::runtime_error("NBT: Unexpected end of data");
+        }
+        if (mStream.avail_in == 0) {
+            mFile.read(reinterpret_cast<char*>(mIn.data()), static_cast<std::streamsize>(mIn.size()));
+            mStream.avail_in = static_cast<uInt>(mFile.gcount());
+            mStream.next_in = mIn.data();
+            if (mStream.avail_in == 0) {
+                throw std::runtime_error("Truncated gzip stream");
+            }
+        }
+
+        mStream.next_out = mOut.data();
+        mStream.avail_out = static_cast<uInt>(mOut.size());
+        int ret = inflate(&mStream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_ERROR || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_NEED_DICT) {
+            throw std::runtime_error("Corrupt gzip stream");
+        }
+        mEnd = ret == Z_STREAM_END;
+        mOutEnd = mOut.size() - mStream.avail_out;
+    }
+}
+
+void InflateReader::read(uint8_t* out, size_t size) {
+    while (size > 0) {
+        if (mOutPos == mOutEnd) {
+            refill();
+        }
+        size_t count = std::min(size, mOutEnd - mOutPos);
+        std::memcpy(out, mOut.data() + mOutPos, count);
+        mOutPos += count;
+        mPosition += count;
+        out += count;
+        size -= count;
+    }
+}
+
+void InflateReader::skip(uint64_t size) {
+    while (size > 0) {
+        if (mOutPos == mOutEnd) {
+            refill();
+        }
+        size_t count = static_cast<size_t>(std::min<uint64_t>(size, mOutEnd - mOutPos));
+        mOutPos += count;
+        mPosition += count;
+        size -= count;
+    }
+}
+
+namespace {
+
+// Walks the NBT on the stream and copies it tag by tag, minus the block arrays
+class SkeletonWriter {
+public:
+    SkeletonWriter(InflateReader& reader, std::vector<uint8_t>& out, std::vector<StreamedArray>& arrays)
+    : mReader(reader),
+      mOut(out),
+      mArrays(arrays) {}
+
+    void writeRoot() {
+        uint8_t type = copyU8();
+        if (type != static_cast<uint8_t>(TagType::Compound)) {
+            throw std::runtime_error("NBT: Root is not a compound");
+        }
+        copyName();
+        copyCompound(std::string(), 0);
+    }
+
+private:
+    static constexpr int kMaxDepth = 512;
+
+    // Per-voxel arrays: Sponge block and biome data, Litematica region block states.
+    // Anything else (block-entity fields included) stays in the skeleton.
+    static bool isVoxelArray(std::string_view path, std::string_view name, TagType type) {
+        if (type == TagType::LongArray) {
+            return name == "BlockStates" && path.starts_with("Regions/");
+        }
+        if (path.empty()) {
+            return name == "BlockData" || name == "BiomeData";
+        }
+        return name == "Data" && (path == "Blocks" || path.ends_with("/Blocks") || path == "Biomes"
+                                  || path.ends_with("/Biomes"));
+    }
+
+    uint8_t copyU8() {
+        uint8_t value = mReader.readByte();
+        mOut.push_back(value);
+        return value;
+    }
+
+    void copy(size_t size) {
+        size_t start = mOut.size();
+        mOut.resize(start + size);
+        mReader.read(mOut.data() + start, size);
+    }
+
+    int32_t readLength() {
+        uint8_t bytes[4];
+        mReader.read(bytes, 4);
+        auto length = static_cast<int32_t>(
+            (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+            | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3]
+        );
+        if (length < 0) {
+            throw std::runtime_error("NBT: Negative length");
+        }
+        return length;
+    }
+
+    void writeLength(int32_t length) {
+        auto value = static_cast<uint32_t>(length);
+        mOut.push_back(static_cast<uint8_t>(value >> 24));
+        mOut.push_back(static_cast<uint8_t>(value >> 16));
+        mOut.push_back(static_cast<uint8_t>(value >> 8));
+        mOut.push_back(static_cast<uint8_t>(value));
+    }
+
+    std::string copyName() {
+        uint8_t high = copyU8();
+        uint8_t low = copyU8();
+        size_t length = (static_cast<size_t>(high) << 8) | low;
+        size_t start = mOut.size();
+        copy(length);
+        return std::string(reinterpret_cast<const char*>(mOut.data() + start), length);
+    }
+
+    void copyArray(const std::string& path, std::string_view name, TagType type, size_t width) {
+        int32_t count = readLength();
+        if (!isVoxelArray(path, name, type)) {
+            writeLength(count);
+            copy(static_cast<size_t>(count) * width);
+            return;
+        }
+
+        StreamedArray array;
+        array.path = path.empty() ? std::string(name) : path + "/" + std::string(name);
+        array.longs = type == TagType::LongArray;
+        array.offset = mReader.getPosition();
+        array.count = static_cast<uint64_t>(count);
+        mArrays.push_back(std::move(array));
+
+        writeLength(0);
+        mReader.skip(static_cast<uint64_t>(count) * width);
+    }
+
+    void copyCompound(const std::string& path, int depth) {
+        if (depth > kMaxDepth) {
+            throw std::runtime_error("NBT: Nesting too deep");
+        }
+        while (true) {
+            auto type = static_cast<TagType>(copyU8());
+            if (type == TagType::End) {
+                break;
+            }
+            std::string name = copyName();
+            copyPayload(type, path, name, depth);
+        }
+    }
+
+    void copyPayload(TagType type, const std::string& path, std::string_view name, int depth) {
+        switch (type) {
+        case TagType::Byte:
+            copy(1);
+            break;
+        case TagType::Short:
+            copy(2);
+            break;
+        case TagType::Int:
+        case TagType::Float:
+            copy(4);
+            break;
+        case TagType::Long:
+        case TagType::Double:
+            copy(8);
+            break;
+        case TagType::String: {
+            uint8_t high = copyU8();
+            uint8_t low = copyU8();
+            copy((static_cast<size_t>(high) << 8) | low);
+            break;
+        }
+        case TagType::ByteArray:
+            copyArray(path, name, type, 1);
+            break;
+        case TagType::IntArray: {
+            int32_t count = readLength();
+            writeLength(count);
+            copy(static_cast<size_t>(count) * 4);
+            break;
+        }
+        case TagType::LongArray:
+            copyArray(path, name, type, 8);
+            break;
+        case TagType::List: {
+            auto elementType = static_cast<TagType>(copyU8());
+            int32_t count = readLength();
+            writeLength(count);
+            std::string childPath = path.empty() ? std::string(name) : path + "/" + std::string(name);
+            for (int32_t i = 0; i < count; i++) {
+                copyPayload(elementType, childPath, std::string_view(), depth + 1);
+            }
+            break;
+        }
+        case TagType::Compound:
+            copyCompound(path.empty() ? std::string(name) : path + "/" + std::string(name), depth + 1);
+            break;
+        default:
+            throw std::runtime_error("NBT: Unknown tag type");
+        }
+    }
+
+    InflateReader& mReader;
+    std::vector<uint8_t>& mOut;
+    std::vector<StreamedArray>& mArrays;
+};
+
+} // namespace
+
+void buildStreamSkeleton(InflateReader& reader, std::vector<uint8_t>& skeleton, std::vector<StreamedArray>& arrays) {
+    SkeletonWriter writer(reader, skeleton, arrays);
+    writer.writeRoot();
+}
+
+StreamWindowReader::StreamWindowReader(std::shared_ptr<const SchematicStreamSource> source, int width, int height,
+                                       int length, size_t windowVoxels)
+: mSource(std::move(source)),
+  mWidth(width),
+  mHeight(height),
+  mLength(length) {
+    if (width <= 0 || height <= 0 || length <= 0) {
+        return;
+    }
+
+    uint64_t planeSize = static_cast<uint64_t>(width) * length;
+    windowVoxels = std::max<size_t>(windowVoxels, 1);
+    if (planeSize <= windowVoxels) {
+        mLayersPerWindow = static_cast<int>(std::min<uint64_t>(windowVoxels / planeSize, height));
+        mWindowCount = (static_cast<size_t>(height) + mLayersPerWindow - 1) / mLayersPerWindow;
+    } else {
+        // One layer is over budget on its own: split it into bands of whole rows
+        mRowsPerBand = static_cast<int>(std::max<size_t>(1, windowVoxels / static_cast<size_t>(width)));
+        size_t bands = (static_cast<size_t>(length) + mRowsPerBand - 1) / mRowsPerBand;
+        mWindowCount = static_cast<size_t>(height) * bands;
+    }
+
+    if (mSource->encoding == StreamEncoding::PackedLongs && mSource->bits > 0) {
+        mEntryLimit = std::min<uint64_t>(mSource->dataCount * 64 / mSource->bits,
+                                         static_cast<uint64_t>(planeSize) * height);
+    }
+}
+
+bool StreamWindowReader::next(StreamWindow& window, std::vector<int>& out) {
+    if (isFinished()) {
+        return false;
+    }
+
+    if (!mOpened) {
+        if (!mReader.open(mSource->path)) {
+            throw std::runtime_error("Failed to open " + mSource->path);
+        }
+        mReader.skip(mSource->dataOffset);
+        mOpened = true;
+    }
+
+    if (mLayersPerWindow > 0) {
+        window.y = mY;
+        window.layers = std::min(mLayersPerWindow, mHeight - mY);
+        window.z = 0;
+        window.rows = mLength;
+        mY += window.layers;
+    } else {
+        window.y = mY;
+        window.layers = 1;
+        window.z = mZ;
+        window.rows = std::min(mRowsPerBand, mLength - mZ);
+        mZ += window.rows;
+        if (mZ >= mLength) {
+            mZ = 0;
+            mY++;
+        }
+    }
+
+    size_t count = static_cast<size_t>(window.layers) * window.rows * mWidth;
+    out.resize(count);
+    if (mSource->encoding == StreamEncoding::VarInt) {
+        decodeVarInts(out.data(), count);
+    } else {
+        decodePackedLongs(out.data(), count);
+    }
+
+    mWindowIndex++;
+    return true;
+}
+
+void StreamWindowReader::decodeVarInts(int* out, size_t count) {
+    uint64_t limit = mSource->dataCount;
+    for (size_t i = 0; i < count; i++) {
+        if (mConsumed >= limit) {
+            out[i] = -1;
+            continue;
+        }
+        int value = 0;
+        int shift = 0;
+        while (mConsumed < limit) {
+            uint8_t b = mReader.readByte();
+            mConsumed++;
+            if (shift < 32) {
+                value |= (b & 0x7F) << shift;
+            }
+            if ((b & 0x80) == 0) {
+                break;
+            }
+            shift += 7;
+        }
+        out[i] = value;
+    }
+}
+
+uint64_t StreamWindowReader::nextWord() {
+    if (mConsumed >= mSource->dataCount) {
+        return 0;
+    }
+    uint8_t bytes[8];
+    mReader.read(bytes, 8);
+    mConsumed++;
+    uint64_t value = 0;
+    for (uint8_t b : bytes) {
+        value = (value << 8) | b;
+    }
+    return value;
+}
+
+// Same layout as unpackBitArray, decoded in order so the words can be streamed
+void StreamWindowReader::decodePackedLongs(int* out, size_t count) {
+    int bits = mSource->bits;
+    uint64_t mask = (uint64_t{1} << bits) - 1;
+
+    for (size_t i = 0; i < count; i++, mEntry++) {
+        if (mEntry >= mEntryLimit) {
+            out[i] = -1;
+            continue;
+        }
+        if (mBit == 64) {
+            mWord = nextWord();
+            mBit = 0;
+        }
+
+        uint64_t value;
+        if (mBit + bits <= 64) {
+            value = (mWord >> mBit) & mask;
+            mBit += bits;
+        } else {
+            // Straddles two words
+            int low = 64 - mBit;
+            value = mWord >> mBit;
+            mWord = nextWord();
+            int high = bits - low;
+            value |= (mWord & ((uint64_t{1} << high) - 1)) << low;
+            mBit = high;
+        }
+        out[i] = static_cast<int>(value);
+    }
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace wooden_axe {
+
+// How the block array of a streamed schematic is encoded
+enum class StreamEncoding : uint8_t {
+    VarInt,     // Sponge BlockData / Blocks.Data: one VarInt per voxel
+    PackedLongs // Litematica BlockStates: fixed-width entries packed LSB-first into longs
+};
+
+// Where the block array of a schematic sits inside its decompressed NBT.
+// Attached to a Schematic loaded with SchematicReader::loadHeaderFromFile; the
+// block array itself never lives in memory and is re-read per paste.
+struct SchematicStreamSource {
+    std::string path;
+    StreamEncoding encoding = StreamEncoding::VarInt;
+    uint64_t dataOffset = 0; // Decompressed offset of the first array element
+    uint64_t dataCount = 0;  // Array elements: bytes (VarInt) or 64-bit words (PackedLongs)
+    int bits = 0;            // Bits per entry (PackedLongs)
+};
+
+// Sequential reader over a gzip (or uncompressed) file with a fixed-size buffer.
+// Throws std::runtime_error on truncated or corrupt input.
+class InflateReader {
+public:
+    InflateReader() = default;
+    ~InflateReader();
+
+    InflateReader(const InflateReader&) = delete;
+    InflateReader& operator=(const InflateReader&) = delete;
+
+    bool open(const std::string& path);
+
+    uint8_t readByte() {
+        if (mOutPos == mOutEnd) {
+            refill();
+        }
+        mPosition++;
+        return mOut[mOutPos++];
+    }
+
+    void read(uint8_t* out, size_t size);
+    void skip(uint64_t size);
+
+    // Decompressed bytes consumed so far
+    uint64_t getPosition() const { return mPosition; }
+
+private:
+    static constexpr size_t kBufferSize = 256 * 1024;
+
+    void refill();
+
+    std::ifstream mFile;
+    z_stream mStream{};
+    bool mGzip = false;
+    bool mInflateReady = false;
+    bool mEnd = false;
+    std::vector<uint8_t> mIn;
+    std::vector<uint8_t> mOut;
+    size_t mOutPos = 0;
+    size_t mOutEnd = 0;
+    uint64_t mPosition = 0;
+};
+
+// A block array kept out of the skeleton document
+struct StreamedArray {
+    std::string path;   // Parent compound names and the tag name joined by '/', root excluded
+    bool longs = false; // LongArray (otherwise ByteArray)
+    uint64_t offset = 0;
+    uint64_t count = 0;
+};
+
+// Copy a schematic's NBT into `skeleton` with the per-voxel arrays (block and
+// biome data) written as empty, recording where each one was instead.
+// Memory stays proportional to the non-block data (palette, block entities).
+void buildStreamSkeleton(InflateReader& reader, std::vector<uint8_t>& skeleton, std::vector<StreamedArray>& arrays);
+
+// One box of voxels decoded from the stream, in schematic-local coordinates:
+// rows [z, z + rows) of layers [y, y + layers). Either whole layers, or a band of
+// rows inside one layer when a single layer is larger than the window budget.
+struct StreamWindow {
+    int y = 0;
+    int layers = 0;
+    int z = 0;
+    int rows = 0;
+};
+
+// Decodes a streamed block array window by window, front to back, holding only
+// the inflate buffers and the caller's window. Voxels past the end of the data are -1.
+class StreamWindowReader {
+public:
+    StreamWindowReader(std::shared_ptr<const SchematicStreamSource> source, int width, int height, int length,
+                       size_t windowVoxels);
+
+    // Fill `out` with the next window; false once every window has been read
+    bool next(StreamWindow& window, std::vector<int>& out);
+
+    bool isFinished() const { return mWindowIndex >= mWindowCount; }
+    size_t getWindowIndex() const { return mWindowIndex; }
+    size_t getWindowCount() const { return mWindowCount; }
+
+private:
+    void decodeVarInts(int* out, size_t count);
+    void decodePackedLongs(int* out, size_t count);
+    uint64_t nextWord();
+
+    std::shared_ptr<const SchematicStreamSource> mSource;
+    InflateReader mReader;
+    bool mOpened = false;
+
+    int mWidth;
+    int mHeight;
+    int mLength;
+    int mLayersPerWindow = 0; // Whole layers per window, 0 when layers are split into bands
+    int mRowsPerBand = 0;
+    size_t mWindowCount = 0;
+    size_t mWindowIndex = 0;
+    int mY = 0;
+    int mZ = 0;
+
+    uint64_t mConsumed = 0; // Array elements read so far
+    uint64_t mEntry = 0;    // PackedLongs: next entry index
+    uint64_t mEntryLimit = 0;
+    uint64_t mWord = 0;
+    int mBit = 64;
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,368 @@
+#include "mod/SectionedBlocks.h"
+#include "mod/Trace.h"
+#include "mod/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <zlib.h>
+
+namespace wooden_axe {
+
+namespace {
+
+// A section is at most 16 KB packed, so a 16 KB window sees all of it.
+// Raw deflate: no zlib header or checksum per section.
+constexpr int kWindowBits = -14;
+
+// Sections to a build task; each task fills its own byte buffer
+constexpr size_t kSectionsPerTask = 256;
+
+std::atomic<uint64_t> gNextId{0};
+
+// One deflate state per thread, reset between sections instead of re-initialized
+struct Deflater {
+    z_stream stream{};
+    bool ready = false;
+
+    ~Deflater() {
+        if (ready) {
+            deflateEnd(&stream);
+        }
+    }
+
+    z_stream& get() {
+        if (!ready) {
+            if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, kWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("Sections: deflateInit failed");
+            }
+            ready = true;
+        } else {
+            deflateReset(&stream);
+        }
+        return stream;
+    }
+};
+
+struct Inflater {
+    z_stream stream{};
+    bool ready = false;
+
+    ~Inflater() {
+        if (ready) {
+            inflateEnd(&stream);
+        }
+    }
+
+    z_stream& get() {
+        if (!ready) {
+            if (inflateInit2(&stream, kWindowBits) != Z_OK) {
+                throw std::runtime_error("Sections: inflateInit failed");
+            }
+            ready = true;
+        } else {
+            inflateReset(&stream);
+        }
+        return stream;
+    }
+};
+
+// Recently decoded deflated sections, looked up by (store id, section index)
+struct DecodedCache {
+    static constexpr int kEntries = 4;
+
+    struct Entry {
+        uint64_t id = 0;
+        size_t index = 0;
+        int values[SectionedBlocks::kVolume];
+    };
+
+    Entry entries[kEntries];
+    int next = 0;
+};
+
+// 64-bit content hash of a packed section (its size is a multiple of 8)
+uint64_t hashPacked(const uint8_t* bytes, size_t size, int width) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(width);
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+thread_local Deflater tDeflater;
+thread_local Inflater tInflater;
+thread_local DecodedCache tCache;
+
+void unpack(const uint8_t* bytes, int width, int* out) {
+    switch (width) {
+    case 1:
+        for (int i = 0; i < SectionedBlocks::kVolume; i++) {
+            out[i] = static_cast<int>(bytes[i]) - 1;
+        }
+        break;
+    case 2:
+        for (int i = 0; i < SectionedBlocks::kVolume; i++) {
+            out[i] = static_cast<int>(bytes[2 * i] | (bytes[2 * i + 1] << 8)) - 1;
+        }
+        break;
+    default:
+        for (int i = 0; i < SectionedBlocks::kVolume; i++) {
+            uint32_t value;
+            std::memcpy(&value, bytes + 4 * i, 4);
+            out[i] = static_cast<int>(value - 1);
+        }
+        break;
+    }
+}
+
+int unpackOne(const uint8_t* bytes, int width, size_t i) {
+    switch (width) {
+    case 1:
+        return static_cast<int>(bytes[i]) - 1;
+    case 2:
+        return static_cast<int>(bytes[2 * i] | (bytes[2 * i + 1] << 8)) - 1;
+    default: {
+        uint32_t value;
+        std::memcpy(&value, bytes + 4 * i, 4);
+        return static_cast<int>(value - 1);
+    }
+    }
+}
+
+} // namespace
+
+void SectionedBlocks::initGrid(int width, int height, int length) {
+    mWidth = std::max(width, 0);
+    mHeight = std::max(height, 0);
+    mLength = std::max(length, 0);
+    mSectionsX = (mWidth + kSize - 1) / kSize;
+    mSectionsY = (mHeight + kSize - 1) / kSize;
+    mSectionsZ = (mLength + kSize - 1) / kSize;
+    mId = ++gNextId;
+    mSections.assign(static_cast<size_t>(mSectionsX) * mSectionsY * mSectionsZ, Section{});
+}
+
+SectionedBlocks SectionedBlocks::fromGrid(const int* grid, size_t gridSize, int width, int height, int length,
+                                          bool compress) {
+    WA_TRACE_ZONE("section blocks");
+    SectionedBlocks result;
+    result.initGrid(width, height, length);
+
+    size_t count = result.mSections.size();
+    size_t taskCount = (count + kSectionsPerTask - 1) / kSectionsPerTask;
+    std::vector<std::vector<uint8_t>> taskData(taskCount);
+    std::vector<uint64_t> hashes(count);
+
+    WorkerPool::getInstance().parallelFor(taskCount, [&](size_t task) {
+        WA_TRACE_ZONE(compress ? "deflate sections" : "pack sections");
+        int values[kVolume];
+        uint8_t packed[kVolume * 4];
+        auto& out = taskData[task];
+
+        size_t end = std::min(count, (task + 1) * kSectionsPerTask);
+        for (size_t index = task * kSectionsPerTask; index < end; index++) {
+            int sectionX = static_cast<int>(index % result.mSectionsX);
+            int sectionZ = static_cast<int>((index / result.mSectionsX) % result.mSectionsZ);
+            int sectionY = static_cast<int>(index / (static_cast<size_t>(result.mSectionsX) * result.mSectionsZ));
+
+            // Gather; voxels past the edge repeat the first one so they never widen or break uniformity
+            bool uniform = true;
+            uint32_t maxEncoded = 0;
+            for (int ly = 0; ly < kSize; ly++) {
+                int y = sectionY * kSize + ly;
+                for (int lz = 0; lz < kSize; lz++) {
+                    int z = sectionZ * kSize + lz;
+                    int* row = values + (ly * kSize + lz) * kSize;
+                    size_t base = (static_cast<size_t>(y) * length + z) * width;
+                    for (int lx = 0; lx < kSize; lx++) {
+                        int x = sectionX * kSize + lx;
+                        int value;
+                        if (y >= height || z >= length || x >= width) {
+                            value = values[0];
+                        } else {
+                            size_t gridIndex = base + x;
+                            value = gridIndex < gridSize ? grid[gridIndex] : -1;
+                        }
+                        row[lx] = value;
+                        uniform = uniform && value == values[0];
+                        maxEncoded = std::max(maxEncoded, static_cast<uint32_t>(value) + 1);
+                    }
+                }
+            }
+
+            Section& section = result.mSections[index];
+            if (uniform) {
+                section.value = values[0];
+                continue;
+            }
+
+            int bytesPerVoxel = maxEncoded < 0x100 ? 1 : maxEncoded < 0x10000 ? 2 : 4;
+            size_t packedSize = static_cast<size_t>(kVolume) * bytesPerVoxel;
+            for (int i = 0; i < kVolume; i++) {
+                auto encoded = static_cast<uint32_t>(values[i]) + 1;
+                for (int b = 0; b < bytesPerVoxel; b++) {
+                    packed[i * bytesPerVoxel + b] = static_cast<uint8_t>(encoded >> (8 * b));
+                }
+            }
+
+            hashes[index] = hashPacked(packed, packedSize, bytesPerVoxel);
+            section.width = static_cast<uint8_t>(bytesPerVoxel);
+            section.offset = out.size();
+            section.kind = Kind::Packed;
+            section.size = static_cast<uint32_t>(packedSize);
+
+            if (compress) {
+                z_stream& stream = tDeflater.get();
+                size_t start = out.size();
+                out.resize(start + deflateBound(&stream, static_cast<uLong>(packedSize)));
+                stream.next_in = packed;
+                stream.avail_in = static_cast<uInt>(packedSize);
+                stream.next_out = out.data() + start;
+                stream.avail_out = static_cast<uInt>(out.size() - start);
+                if (deflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out < packedSize) {
+                    out.resize(start + stream.total_out);
+                    section.kind = Kind::Deflated;
+                    section.size = static_cast<uint32_t>(stream.total_out);
+                    continue;
+                }
+                out.resize(start); // Did not shrink: keep it packed
+            }
+            out.insert(out.end(), packed, packed + packedSize);
+        }
+    });
+
+    // Store each distinct section once. Encoding is deterministic, so equal contents
+    // give equal bytes and the comparison below settles hash collisions.
+    std::unordered_map<uint64_t, size_t> firstByHash;
+    for (size_t task = 0; task < taskCount; task++) {
+        const auto& data = taskData[task];
+        size_t end = std::min(count, (task + 1) * kSectionsPerTask);
+        for (size_t index = task * kSectionsPerTask; index < end; index++) {
+            Section& section = result.mSections[index];
+            if (section.kind == Kind::Uniform) {
+                continue;
+            }
+            const uint8_t* bytes = data.data() + section.offset;
+
+            auto [it, inserted] = firstByHash.try_emplace(hashes[index], index);
+            if (!inserted) {
+                const Section& first = result.mSections[it->second];
+                if (first.kind == section.kind && first.width == section.width && first.size == section.size
+                    && std::memcmp(result.mData.data() + first.offset, bytes, section.size) == 0) {
+                    section.offset = first.offset;
+                    continue;
+                }
+            }
+            section.offset = result.mData.size();
+            result.mData.insert(result.mData.end(), bytes, bytes + section.size);
+            result.mStoredSections++;
+        }
+        std::vector<uint8_t>().swap(taskData[task]);
+    }
+    result.mData.shrink_to_fit();
+    return result;
+}
+
+SectionedBlocks SectionedBlocks::fromSections(int width, int height, int length, std::vector<Section> sections,
+                                              std::vector<uint8_t> data) {
+    SectionedBlocks result;
+    result.initGrid(width, height, length);
+    if (sections.size() != result.mSections.size()) {
+        throw std::runtime_error("Sections: count does not match dimensions");
+    }
+
+    std::vector<uint64_t> offsets;
+    for (auto& section : sections) {
+        if (section.kind == Kind::Uniform) {
+            section.size = 0;
+            section.offset = 0;
+            continue;
+        }
+        if (section.kind != Kind::Packed && section.kind != Kind::Deflated) {
+            throw std::runtime_error("Sections: unknown section kind");
+        }
+        if (section.width != 1 && section.width != 2 && section.width != 4) {
+            throw std::runtime_error("Sections: invalid voxel width");
+        }
+        if (section.kind == Kind::Packed ? section.size != static_cast<uint32_t>(kVolume) * section.width
+                                         : section.size == 0) {
+            throw std::runtime_error("Sections: invalid section size");
+        }
+        if (section.offset > data.size() || section.size > data.size() - section.offset) {
+            throw std::runtime_error("Sections: section out of range");
+        }
+        offsets.push_back(section.offset);
+    }
+    std::sort(offsets.begin(), offsets.end());
+    result.mStoredSections = std::unique(offsets.begin(), offsets.end()) - offsets.begin();
+
+    result.mSections = std::move(sections);
+    result.mData = std::move(data);
+    return result;
+}
+
+void SectionedBlocks::decode(size_t index, int* out) const {
+    const Section& section = mSections[index];
+    switch (section.kind) {
+    case Kind::Uniform:
+        std::fill(out, out + kVolume, section.value);
+        return;
+    case Kind::Packed:
+        unpack(mData.data() + section.offset, section.width, out);
+        return;
+    case Kind::Deflated:
+        break;
+    }
+
+    uint8_t packed[kVolume * 4];
+    size_t packedSize = static_cast<size_t>(kVolume) * section.width;
+    z_stream& stream = tInflater.get();
+    stream.next_in = const_cast<Bytef*>(mData.data() + section.offset);
+    stream.avail_in = section.size;
+    stream.next_out = packed;
+    stream.avail_out = static_cast<uInt>(packedSize);
+    if (inflate(&stream, Z_FINISH) != Z_STREAM_END || stream.total_out != packedSize) {
+        throw std::runtime_error("Sections: corrupt section data");
+    }
+    unpack(packed, section.width, out);
+}
+
+int SectionedBlocks::get(int x, int y, int z) const {
+    if (x < 0 || x >= mWidth || y < 0 || y >= mHeight || z < 0 || z >= mLength) {
+        return -1;
+    }
+    size_t index = getSectionIndex(x / kSize, y / kSize, z / kSize);
+    size_t local = (static_cast<size_t>(y % kSize) * kSize + z % kSize) * kSize + x % kSize;
+
+    const Section& section = mSections[index];
+    switch (section.kind) {
+    case Kind::Uniform:
+        return section.value;
+    case Kind::Packed:
+        return unpackOne(mData.data() + section.offset, section.width, local);
+    case Kind::Deflated:
+        break;
+    }
+
+    auto& cache = tCache;
+    for (auto& entry : cache.entries) {
+        if (entry.id == mId && entry.index == index) {
+            return entry.values[local];
+        }
+    }
+    auto& entry = cache.entries[cache.next];
+    cache.next = (cache.next + 1) % DecodedCache::kEntries;
+    entry.id = 0; // Invalid until decoded, in case decode throws
+    decode(index, entry.values);
+    entry.id = mId;
+    entry.index = index;
+    return entry.values[local];
+}
+
+} // namespace wooden_axe
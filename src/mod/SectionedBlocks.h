@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wooden_axe {
+
+// Palette indices of a schematic stored as 16x16x16 sections in schematic-local
+// coordinates. A section that holds one value keeps just that value; the others are
+// packed at 1, 2 or 4 bytes per voxel and, unless built raw, deflated. Sections with
+// identical contents share one copy of their bytes (the same offset).
+// Immutable once built, so it can be read from any thread.
+class SectionedBlocks {
+public:
+    static constexpr int kSize = 16;
+    static constexpr int kVolume = kSize * kSize * kSize;
+
+    enum class Kind : uint8_t {
+        Uniform, // Every voxel is `value`
+        Packed,  // `size` bytes at `offset`: voxels as (index + 1) in `width` bytes, little-endian
+        Deflated // Same bytes, raw-deflated
+    };
+
+    struct Section {
+        int32_t value = -1;
+        Kind kind = Kind::Uniform;
+        uint8_t width = 0;
+        uint32_t size = 0;
+        uint64_t offset = 0;
+    };
+
+    SectionedBlocks() = default;
+
+    // Section a linear grid (index = (y * length + z) * width + x); voxels at or past
+    // gridSize are missing (-1). Sections are built on the worker pool.
+    static SectionedBlocks fromGrid(const int* grid, size_t gridSize, int width, int height, int length,
+                                    bool compress);
+
+    // Reassemble from serialized sections; several may point at the same bytes.
+    // Throws std::runtime_error if they do not describe the given dimensions.
+    static SectionedBlocks fromSections(int width, int height, int length, std::vector<Section> sections,
+                                        std::vector<uint8_t> data);
+
+    bool empty() const { return mSections.empty(); }
+
+    int getSectionsX() const { return mSectionsX; }
+    int getSectionsY() const { return mSectionsY; }
+    int getSectionsZ() const { return mSectionsZ; }
+    size_t getSectionCount() const { return mSections.size(); }
+
+    // Distinct non-uniform sections actually stored
+    size_t getStoredSectionCount() const { return mStoredSections; }
+
+    size_t getSectionIndex(int sectionX, int sectionY, int sectionZ) const {
+        return (static_cast<size_t>(sectionY) * mSectionsZ + sectionZ) * mSectionsX + sectionX;
+    }
+
+    const Section& getSection(size_t index) const { return mSections[index]; }
+    const std::vector<Section>& getSections() const { return mSections; }
+    const std::vector<uint8_t>& getData() const { return mData; }
+
+    // All voxels of a section, indexed (y * 16 + z) * 16 + x. Voxels past the
+    // schematic's edge hold an unspecified in-range value.
+    void decode(size_t index, int* out) const;
+
+    // Palette index at a schematic-local position, -1 outside or missing.
+    // Deflated sections go through a small per-thread cache of decoded sections.
+    int get(int x, int y, int z) const;
+
+    // Heap bytes held
+    size_t getMemoryUsage() const { return mSections.capacity() * sizeof(Section) + mData.capacity(); }
+
+private:
+    void initGrid(int width, int height, int length);
+
+    int mWidth = 0;
+    int mHeight = 0;
+    int mLength = 0;
+    int mSectionsX = 0;
+    int mSectionsY = 0;
+    int mSectionsZ = 0;
+    uint64_t mId = 0; // Cache key; copies share it since the contents never change
+    size_t mStoredSections = 0;
+    std::vector<Section> mSections;
+    std::vector<uint8_t> mData;
+};
+
+} // namespace wooden_axe
@@ -0,0 +1,175 @@
+#include "mod/SelectionOperations.h"
+
+#include "mc/world/level/block/Block.h"
+#include "mc/world/level/block/registry/BlockTypeRegistry.h"
+
+#include <algorithm>
+
+namespace wooden_axe {
+
+const Block* resolveBlockName(const std::string& name) {
+    if (name.empty()) {
+        return nullptr;
+    }
+    std::string fullName = name.find(':') == std::string::npos ? "minecraft:" + name : name;
+    return BlockTypeRegistry::lookupByName(fullName, false);
+}
+
+RegionFillJob::RegionFillJob(const BlockBox& box, int dimension, const Block& target, BlockMatchSet match,
+                             std::function<void(const RegionOperationResult&)> onComplete)
+: mBox(box),
+  mTarget(&target),
+  mMatch(std::move(match)),
+  mOnComplete(std::move(onComplete)),
+  mSink(makeDimensionSink(dimension)),
+  mPreloader(*mSink, std::chrono::seconds(WoodenAxeMod::getInstance().getConfig().chunkLoadTimeoutSeconds)) {
+    // Subchunk-aligned cells clipped to the box, grouped per chunk column so each
+    // column is loaded once and consecutive writes share a subchunk
+    for (int cz = box.min.z >> 4; cz <= box.max.z >> 4; cz++) {
+        for (int cx = box.min.x >> 4; cx <= box.max.x >> 4; cx++) {
+            Column column{cx, cz, mCells.size(), 0};
+            for (int cy = box.min.y >> 4; cy <= box.max.y >> 4; cy++) {
+                Cell cell;
+                cell.minX = std::max(box.min.x, cx * 16);
+                cell.minY = std::max(box.min.y, cy * 16);
+                cell.minZ = std::max(box.min.z, cz * 16);
+                cell.sizeX = std::min(box.max.x, cx * 16 + 15) - cell.minX + 1;
+                cell.sizeY = std::min(box.max.y, cy * 16 + 15) - cell.minY + 1;
+                cell.sizeZ = std::min(box.max.z, cz * 16 + 15) - cell.minZ + 1;
+                mCells.push_back(cell);
+            }
+            column.endCell = mCells.size();
+            mColumns.push_back(column);
+        }
+    }
+}
+
+bool RegionFillJob::requestAhead() {
+    size_t lookahead = std::max<size_t>(1, WoodenAxeMod::getInstance().getConfig().preloadChunks);
+    while (mNextRequest < mColumns.size() && mNextRequest < mColumnIndex + lookahead) {
+        const auto& column = mColumns[mNextRequest];
+        if (!mPreloader.request(column.chunkX, column.chunkZ)) {
+            return false;
+        }
+        mNextRequest++;
+    }
+    return true;
+}
+
+// Count what is left of these cells as failed and done (mCellCursor applies to firstCell)
+void RegionFillJob::failRemaining(size_t firstCell, size_t endCell) {
+    for (size_t i = firstCell; i < endCell; i++) {
+        const Cell& cell = mCells[i];
+        size_t left = static_cast<size_t>(cell.sizeX) * cell.sizeY * cell.sizeZ;
+        if (i == firstCell) {
+            left -= mCellCursor;
+        }
+        mResult.failed += left;
+        mDone += left;
+    }
+    mCellCursor = 0;
+}
+
+void RegionFillJob::closeColumn() {
+    const auto& column = mColumns[mColumnIndex];
+    if (mColumnOpen) {
+        mSink->endChunk();
+        mColumnOpen = false;
+    }
+    mPreloader.release(column.chunkX, column.chunkZ);
+    mColumnIndex++;
+    if (mColumnIndex < mColumns.size()) {
+        mCellIndex = mColumns[mColumnIndex].firstCell;
+    }
+}
+
+size_t RegionFillJob::runSlice(size_t budget) {
+    auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+
+    size_t used = 0;
+    while (used < budget && mColumnIndex < mColumns.size()) {
+        const Column& column = mColumns[mColumnIndex];
+        if (!mColumnOpen) {
+            ChunkLoadState state = ChunkLoadState::Loading;
+            if (requestAhead()) {
+                state = mPreloader.poll(column.chunkX, column.chunkZ);
+                if (state == ChunkLoadState::Loading) {
+                    return used; // Check again next tick
+                }
+                if (state == ChunkLoadState::TimedOut) {
+                    logger.warn("Chunk ({}, {}) did not load in time, skipping it", column.chunkX, column.chunkZ);
+                    failRemaining(mCellIndex, column.endCell);
+                    closeColumn();
+                    continue;
+                }
+            }
+            if (state != ChunkLoadState::Ready || !mSink->beginChunk(column.chunkX, column.chunkZ)) {
+                // World is gone: finish with what was done
+                failRemaining(mCellIndex, mCells.size());
+                mPreloader.clear();
+                mColumnIndex = mColumns.size();
+                return used;
+            }
+            mColumnOpen = true;
+        }
+
+        const Cell& cell = mCells[mCellIndex];
+        int volume = cell.sizeX * cell.sizeY * cell.sizeZ;
+        int planeSize = cell.sizeX * cell.sizeZ;
+
+        while (mCellCursor < volume && used < budget) {
+            int y = cell.minY + mCellCursor / planeSize;
+            int z = cell.minZ + (mCellCursor % planeSize) / cell.sizeX;
+            int x = cell.minX + mCellCursor % cell.sizeX;
+            mCellCursor++;
+            used++;
+            mDone++;
+
+            if (!mMatch.empty()) {
+                const Block* current = mSink->getBlock(x, y, z);
+                if (!current || !mMatch.contains(*current)) {
+                    mResult.untouched++;
+                    continue;
+                }
+            }
+
+            if (mSink->setBlock(x, y, z, *mTarget, true)) {
+                mResult.changed++;
+            } else {
+                mResult.failed++;
+            }
+        }
+
+        if (mCellCursor >= volume) {
+            mCellIndex++;
+            mCellCursor = 0;
+            if (mCellIndex >= column.endCell) {
+                closeColumn();
+            }
+        }
+    }
+    return used;
+}
+
+std::string RegionFillJob::describe() const {
+    return std::string(mMatch.empty() ? "set " : "replace -> ") + mSink->getBlockTypeName(*mTarget) + " in "
+         + std::to_string(mBox.max.x - mBox.min.x + 1) + "x" + std::to_string(mBox.max.y - mBox.min.y + 1) + "x"
+         + std::to_string(mBox.max.z - mBox.min.z + 1);
+}
+
+void RegionFillJob::onFinished() {
+    mPreloader.clear();
+    if (mOnComplete) {
+        mOnComplete(mResult);
+    }
+}
+
+void RegionFillJob::onCancelled() {
+    if (mColumnOpen) {
+        mSink->endChunk();
+        mColumnOpen = false;
+    }
+    mPreloader.clear();
+}
+
+} // namespace wooden_axe
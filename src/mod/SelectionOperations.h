@@ -0,0 +1,76 @@
+#pragma once
+
+#include "mod/BlockMatchSet.h"
+#include "mod/ChunkPreloader.h"
+#include "mod/JobScheduler.h"
+#include "mod/WoodenAxeMod.h"
+#include "mod/WorldSink.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Block;
+
+namespace wooden_axe {
+
+// Resolve a user-typed block name ("stone" or "minecraft:stone") once, before any work starts
+const Block* resolveBlockName(const std::string& name);
+
+struct RegionOperationResult {
+    size_t changed = 0;
+    size_t untouched = 0; // Replace: blocks that did not match
+    size_t failed = 0;    // Refused by the world, or in a chunk that did not load in time
+};
+
+// Fill (or replace within) a box, one 16x16x16 subchunk cell at a time. Chunk columns are
+// loaded ahead through a ChunkPreloader and held until their cells are done, like a paste.
+class RegionFillJob : public TickJob {
+public:
+    RegionFillJob(const BlockBox& box, int dimension, const Block& target, BlockMatchSet match,
+                  std::function<void(const RegionOperationResult&)> onComplete);
+
+    size_t runSlice(size_t budget) override;
+    bool isFinished() const override { return mColumnIndex >= mColumns.size(); }
+    void onFinished() override;
+    void onCancelled() override;
+    std::string describe() const override;
+    size_t getTotalWork() const override { return mBox.getVolume(); }
+    size_t getDoneWork() const override { return mDone; }
+
+private:
+    struct Cell {
+        int minX, minY, minZ;
+        int sizeX, sizeY, sizeZ; // Clipped to the box
+    };
+
+    // The cells of one chunk column, bottom to top
+    struct Column {
+        int chunkX, chunkZ;
+        size_t firstCell, endCell;
+    };
+
+    bool requestAhead();
+    void failRemaining(size_t firstCell, size_t endCell);
+    void closeColumn();
+
+    BlockBox mBox;
+    const Block* mTarget;
+    BlockMatchSet mMatch;
+    std::function<void(const RegionOperationResult&)> mOnComplete;
+
+    std::shared_ptr<WorldSink> mSink;
+    ChunkPreloader mPreloader;
+    std::vector<Cell> mCells;
+    std::vector<Column> mColumns;
+    size_t mColumnIndex = 0;
+    size_t mNextRequest = 0; // First column not requested yet
+    bool mColumnOpen = false;
+    size_t mCellIndex = 0;
+    int mCellCursor = 0; // Linear offset into the current cell (y, z, x order)
+    size_t mDone = 0;
+    RegionOperationResult mResult;
+};
+
+} // namespace wooden_axe
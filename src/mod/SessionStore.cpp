@@ -0,0 +1,386 @@
+#include "mod/SessionStore.h"
+#include "mod/ClipboardSpill.h"
+#include "mod/SchematicCache.h"
+#include "mod/WorkerPool.h"
+
+#include "ll/api/chrono/GameChrono.h"
+#include "ll/api/coro/CoroTask.h"
+#include "ll/api/thread/ServerThreadExecutor.h"
+#include "mc/world/actor/player/Player.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace wooden_axe {
+
+PlayerId getPlayerId(const Player& player) {
+    const auto& uuid = player.getUuid();
+    return PlayerId{uuid.a, uuid.b};
+}
+
+PlayerSelection PlayerSession::getSelection() const {
+    std::lock_guard lock(mMutex);
+    return mSelection;
+}
+
+void PlayerSession::setPos1(const BlockPos& pos, int dim) {
+    std::lock_guard lock(mMutex);
+    mSelection.pos1 = pos;
+    mSelection.dimension = dim;
+}
+
+void PlayerSession::setPos2(const BlockPos& pos, int dim) {
+    std::lock_guard lock(mMutex);
+    mSelection.pos2 = pos;
+    mSelection.dimension = dim;
+}
+
+void PlayerSession::clearSelection() {
+    std::lock_guard lock(mMutex);
+    mSelection = PlayerSelection{};
+}
+
+std::shared_ptr<const Schematic> PlayerSession::getClipboard() {
+    touchClipboard();
+    return mClipboard.load();
+}
+
+void PlayerSession::setClipboard(std::shared_ptr<const Schematic> schem) {
+    size_t bytes = schem ? schem->getMemoryUsage() : 0;
+
+    std::lock_guard lock(mClipboardMutex);
+    if (!mSpillPath.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(mSpillPath, ec);
+        mSpillPath.clear();
+    }
+    mSpillBytes = 0;
+    mDropped = false;
+    mClipboardBytes = bytes;
+    mClipboard.store(std::move(schem));
+    touchClipboard();
+}
+
+ClipboardUsage PlayerSession::getClipboardUsage() const {
+    std::lock_guard lock(mClipboardMutex);
+
+    ClipboardUsage usage;
+    bool resident = mClipboard.load() != nullptr;
+    usage.residentBytes = resident ? mClipboardBytes : 0;
+    usage.spilledBytes = mSpillBytes;
+    usage.spilled = !resident && !mSpillPath.empty();
+    usage.dropped = !resident && mDropped;
+    usage.lastUsed = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(mLastUsed.load()));
+    return usage;
+}
+
+bool PlayerSession::hasSpillFile() const {
+    std::lock_guard lock(mClipboardMutex);
+    return !mSpillPath.empty();
+}
+
+bool PlayerSession::beginSpill() {
+    std::lock_guard lock(mClipboardMutex);
+    if (mSpillPending || !mClipboard.load()) {
+        return false;
+    }
+    mSpillPending = true;
+    return true;
+}
+
+void PlayerSession::cancelSpill() {
+    std::lock_guard lock(mClipboardMutex);
+    mSpillPending = false;
+}
+
+bool PlayerSession::evictClipboard(const std::shared_ptr<const Schematic>& expected, std::filesystem::path spillPath,
+                                   size_t spillBytes) {
+    std::lock_guard lock(mClipboardMutex);
+    mSpillPending = false;
+
+    // Replaced (or restored and replaced) while the copy was being written
+    if (mClipboard.load() != expected) {
+        if (!spillPath.empty() && spillPath != mSpillPath) {
+            std::error_code ec;
+            std::filesystem::remove(spillPath, ec);
+        }
+        return false;
+    }
+
+    if (!spillPath.empty()) {
+        mSpillPath = std::move(spillPath);
+        mSpillBytes = spillBytes;
+    }
+    mDropped = mSpillPath.empty();
+    mClipboard.store(nullptr);
+    return true;
+}
+
+std::filesystem::path PlayerSession::beginRestore(RestoreCallback onRestored) {
+    std::lock_guard lock(mClipboardMutex);
+    mRestoreWaiters.push_back(std::move(onRestored));
+    return mRestoreWaiters.size() == 1 ? mSpillPath : std::filesystem::path();
+}
+
+std::vector<PlayerSession::RestoreCallback> PlayerSession::finishRestore(const std::filesystem::path& path,
+                                                                         std::shared_ptr<const Schematic> restored,
+                                                                         std::shared_ptr<const Schematic>& current) {
+    std::lock_guard lock(mClipboardMutex);
+    current = mClipboard.load();
+    // A new /waload while the file was read wins over the old copy
+    if (!current && restored && mSpillPath == path) {
+        mClipboardBytes = restored->getMemoryUsage();
+        mClipboard.store(restored);
+        current = std::move(restored);
+    }
+    touchClipboard();
+    return std::exchange(mRestoreWaiters, {});
+}
+
+void PlayerSession::addJob(const std::shared_ptr<TickJob>& job) {
+    std::lock_guard lock(mMutex);
+    mJobs.push_back(job);
+}
+
+std::vector<std::shared_ptr<TickJob>> PlayerSession::getActiveJobs() {
+    std::lock_guard lock(mMutex);
+
+    std::vector<std::shared_ptr<TickJob>> active;
+    mJobs.erase(
+        std::remove_if(
+            mJobs.begin(),
+            mJobs.end(),
+            [&](const std::weak_ptr<TickJob>& weak) {
+                auto job = weak.lock();
+                if (!job || !job->isActive()) {
+                    return true;
+                }
+                active.push_back(std::move(job));
+                return false;
+            }
+        ),
+        mJobs.end()
+    );
+    return active;
+}
+
+std::shared_ptr<PlayerSession> SessionStore::find(PlayerId id) const {
+    auto sessions = mSessions.load();
+    auto it = sessions->find(id);
+    return it != sessions->end() ? it->second : nullptr;
+}
+
+std::shared_ptr<PlayerSession> SessionStore::getOrCreate(PlayerId id, const std::string& name) {
+    if (auto session = find(id)) {
+        return session;
+    }
+
+    std::lock_guard lock(mWriteMutex);
+
+    // Another writer may have inserted it while we waited
+    auto current = mSessions.load();
+    if (auto it = current->find(id); it != current->end()) {
+        return it->second;
+    }
+
+    auto session = std::make_shared<PlayerSession>(id, name);
+    auto updated = std::make_shared<SessionMap>(*current);
+    updated->emplace(id, session);
+    mSessions.store(std::move(updated));
+    return session;
+}
+
+std::shared_ptr<PlayerSession> SessionStore::getOrCreate(const Player& player) {
+    PlayerId id = getPlayerId(player);
+    if (auto session = find(id)) {
+        return session;
+    }
+    return getOrCreate(id, player.getRealName());
+}
+
+std::vector<std::shared_ptr<PlayerSession>> SessionStore::getAll() const {
+    auto sessions = mSessions.load();
+
+    std::vector<std::shared_ptr<PlayerSession>> result;
+    result.reserve(sessions->size());
+    for (const auto& [id, session] : *sessions) {
+        result.push_back(session);
+    }
+    return result;
+}
+
+void SessionStore::clear() {
+    std::lock_guard lock(mWriteMutex);
+    mSessions.store(std::make_shared<const SessionMap>());
+
+    // Spill files only mean something to the sessions that wrote them
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(getSpillDir(), ec)) {
+        if (entry.path().extension() == ".wacb") {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
+
+std::filesystem::path SessionStore::getSpillDir() const {
+    return WoodenAxeMod::getInstance().getSelf().getDataDir() / "clipboards";
+}
+
+void SessionStore::start() {
+    if (mRunning) {
+        return;
+    }
+    mRunning = true;
+
+    using namespace ll::chrono_literals;
+    uint64_t generation = ++mGeneration;
+    ll::coro::keepThis([this, generation]() -> ll::coro::CoroTask<> {
+        while (mRunning && mGeneration == generation) {
+            co_await 1200_tick; // Once a minute
+            if (mGeneration != generation) {
+                break;
+            }
+            enforceMemoryLimit();
+        }
+    }).launch(ll::thread::ServerThreadExecutor::getDefault());
+}
+
+void SessionStore::stop() {
+    mRunning = false;
+    ++mGeneration;
+}
+
+void SessionStore::restoreClipboard(std::shared_ptr<PlayerSession> session,
+                                    PlayerSession::RestoreCallback onRestored) {
+    if (auto schem = session->getClipboard()) {
+        onRestored(std::move(schem));
+        return;
+    }
+    if (!session->getClipboardUsage().spilled) {
+        onRestored(nullptr);
+        return;
+    }
+    auto path = session->beginRestore(std::move(onRestored));
+    if (path.empty()) {
+        return; // Joins the read already running
+    }
+
+    // Reading and inflating a large clipboard would stall the tick
+    WorkerPool::getInstance().submit([this, session, path] {
+        std::shared_ptr<const Schematic> restored;
+        if (auto schem = readClipboardSpill(path)) {
+            restored = std::make_shared<const Schematic>(std::move(*schem));
+        }
+
+        ll::thread::ServerThreadExecutor::getDefault().execute([this, session, path, restored] {
+            auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+            if (restored) {
+                logger.debug("Restored clipboard of {} from disk ({} bytes)", session->getName(),
+                             restored->getMemoryUsage());
+            } else {
+                logger.error("Failed to restore clipboard of {} from {}", session->getName(), path.string());
+            }
+
+            std::shared_ptr<const Schematic> current;
+            for (auto& callback : session->finishRestore(path, restored, current)) {
+                callback(current);
+            }
+
+            // Back in memory: make room again if that went over the limit
+            enforceMemoryLimit();
+        });
+    });
+}
+
+size_t SessionStore::getClipboardMemory() const {
+    size_t total = 0;
+    for (const auto& session : getAll()) {
+        if (!SchematicCache::getInstance().contains(session->peekClipboard())) {
+            total += session->getClipboardUsage().residentBytes;
+        }
+    }
+    return total;
+}
+
+void SessionStore::enforceMemoryLimit() {
+    auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+    const auto& config = WoodenAxeMod::getInstance().getConfig();
+
+    size_t limit = config.clipboardMemoryLimitMB * 1024 * 1024;
+    auto idleLimit = std::chrono::minutes(config.clipboardIdleMinutes);
+    auto now = std::chrono::steady_clock::now();
+
+    struct Candidate {
+        std::shared_ptr<PlayerSession> session;
+        ClipboardUsage usage;
+    };
+    std::vector<Candidate> candidates;
+    size_t total = 0;
+    for (auto& session : getAll()) {
+        auto usage = session->getClipboardUsage();
+        if (usage.residentBytes == 0 || SchematicCache::getInstance().contains(session->peekClipboard())) {
+            continue; // Prewarmed schematics stay in the cache whatever this session does
+        }
+        total += usage.residentBytes;
+        // A running paste keeps its own reference, evicting would free nothing
+        if (session->getActiveJobs().empty()) {
+            candidates.push_back({std::move(session), usage});
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.usage.lastUsed < b.usage.lastUsed;
+    });
+
+    for (auto& [session, usage] : candidates) {
+        bool idle = config.clipboardIdleMinutes > 0 && now - usage.lastUsed > idleLimit;
+        if (total <= limit && !idle) {
+            break; // Sorted oldest first: everything after is newer still
+        }
+
+        // Streamed clipboards hold only a header, their blocks are already on disk
+        auto schem = session->peekClipboard();
+        if (!schem || schem->stream || !session->beginSpill()) {
+            continue;
+        }
+        total -= std::min(total, usage.residentBytes);
+
+        // Unchanged since the last restore: the file on disk is still valid
+        if (!config.spillClipboardsToDisk || session->hasSpillFile()) {
+            session->evictClipboard(schem, {}, 0);
+            logger.info("Evicted clipboard of {} ({} KB)", session->getName(), usage.residentBytes / 1024);
+            continue;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(getSpillDir(), ec);
+        char fileName[64];
+        std::snprintf(fileName, sizeof(fileName), "%016llx%016llx.wacb",
+                      static_cast<unsigned long long>(session->getId().high),
+                      static_cast<unsigned long long>(session->getId().low));
+        auto path = getSpillDir() / fileName;
+
+        // Serialization and compression run on a worker, the swap happens back here
+        WorkerPool::getInstance().submit([session, schem, path, resident = usage.residentBytes] {
+            bool ok = writeClipboardSpill(*schem, path);
+            std::error_code sizeError;
+            size_t bytes = ok ? static_cast<size_t>(std::filesystem::file_size(path, sizeError)) : 0;
+
+            ll::thread::ServerThreadExecutor::getDefault().execute([session, schem, path, ok, bytes, resident] {
+                auto& logger = WoodenAxeMod::getInstance().getSelf().getLogger();
+                if (!ok) {
+                    logger.error("Failed to spill clipboard of {} to {}", session->getName(), path.string());
+                    session->cancelSpill();
+                    return;
+                }
+                if (session->evictClipboard(schem, path, bytes)) {
+                    logger.info("Spilled clipboard of {} to disk ({} KB -> {} KB)", session->getName(),
+                                resident / 1024, bytes / 1024);
+                }
+            });
+        });
+    }
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "mod/SchematicReader.h"
+#include "mod/JobScheduler.h"
+#include "mod/WoodenAxeMod.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+
+namespace wooden_axe {
+
+// Stable per-player key taken from the player's UUID, hashed without touching strings
+struct PlayerId {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const PlayerId& other) const { return high == other.high && low == other.low; }
+};
+
+struct PlayerIdHash {
+    size_t operator()(const PlayerId& id) const {
+        return static_cast<size_t>(id.high ^ (id.low * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+PlayerId getPlayerId(const Player& player);
+
+// Memory snapshot of one clipboard for accounting and /wastats
+struct ClipboardUsage {
+    size_t residentBytes = 0; // In memory, 0 when spilled or empty
+    size_t spilledBytes = 0;  // Size of the on-disk copy, 0 if none
+    bool spilled = false;     // Evicted; the next getClipboard() reads it back
+    bool dropped = false;     // Evicted without a disk copy, must be loaded again
+    std::chrono::steady_clock::time_point lastUsed{};
+};
+
+// Everything the plugin tracks for one player.
+// Safe to read from worker threads: the selection is copied under a short lock
+// and the clipboard is an atomically swapped shared pointer.
+class PlayerSession {
+public:
+    PlayerSession(PlayerId id, std::string name) : mId(id), mName(std::move(name)) {}
+
+    PlayerId getId() const { return mId; }
+    const std::string& getName() const { return mName; }
+
+    // Selection
+    PlayerSelection getSelection() const;
+    void setPos1(const BlockPos& pos, int dim);
+    void setPos2(const BlockPos& pos, int dim);
+    void clearSelection();
+
+    // Clipboard (loaded schematic) if it is in memory, marking it used.
+    // A spilled one comes back through SessionStore::restoreClipboard.
+    std::shared_ptr<const Schematic> getClipboard();
+    void setClipboard(std::shared_ptr<const Schematic> schem);
+
+    ClipboardUsage getClipboardUsage() const;
+
+    // Eviction, driven by SessionStore (server thread)
+    std::shared_ptr<const Schematic> peekClipboard() const { return mClipboard.load(); }
+    bool hasSpillFile() const;
+    bool beginSpill();
+    void cancelSpill();
+    // Drops the resident copy if it is still `expected`; keeps spillPath as the way back (empty = dropped)
+    bool evictClipboard(const std::shared_ptr<const Schematic>& expected, std::filesystem::path spillPath,
+                        size_t spillBytes);
+
+    // Read-back of the spill file, driven by SessionStore (server thread).
+    // beginRestore returns the file to read, or an empty path if a read is already running.
+    using RestoreCallback = std::function<void(std::shared_ptr<const Schematic>)>;
+    std::filesystem::path beginRestore(RestoreCallback onRestored);
+    // Installs `restored` unless the clipboard changed meanwhile; returns the callbacks to run
+    // with `current`, the clipboard now in memory (nullptr if the read failed)
+    std::vector<RestoreCallback> finishRestore(const std::filesystem::path& path,
+                                               std::shared_ptr<const Schematic> restored,
+                                               std::shared_ptr<const Schematic>& current);
+
+    // Jobs this player started that are still queued or running
+    void addJob(const std::shared_ptr<TickJob>& job);
+    std::vector<std::shared_ptr<TickJob>> getActiveJobs();
+
+private:
+    const PlayerId mId;
+    const std::string mName;
+
+    mutable std::mutex mMutex; // Guards mSelection and mJobs
+    PlayerSelection mSelection;
+    std::vector<std::weak_ptr<TickJob>> mJobs;
+
+    void touchClipboard() { mLastUsed.store(std::chrono::steady_clock::now().time_since_epoch().count()); }
+
+    std::atomic<std::shared_ptr<const Schematic>> mClipboard;
+    std::atomic<int64_t> mLastUsed{0};
+
+    mutable std::mutex mClipboardMutex; // Guards the fields below and clipboard swaps
+    size_t mClipboardBytes = 0;
+    std::filesystem::path mSpillPath; // On-disk copy of the current clipboard, if any
+    size_t mSpillBytes = 0;
+    bool mSpillPending = false;
+    bool mDropped = false; // Evicted without a disk copy
+    std::vector<RestoreCallback> mRestoreWaiters; // Non-empty while the spill file is being read
+};
+
+// Read-mostly map of sessions. Lookups load an immutable snapshot without locking;
+// inserts (first event of a new player) copy the map under a writer mutex.
+class SessionStore {
+public:
+    static SessionStore& getInstance() {
+        static SessionStore instance;
+        return instance;
+    }
+
+    std::shared_ptr<PlayerSession> find(PlayerId id) const;
+    std::shared_ptr<PlayerSession> getOrCreate(PlayerId id, const std::string& name);
+    std::shared_ptr<PlayerSession> getOrCreate(const Player& player);
+
+    std::vector<std::shared_ptr<PlayerSession>> getAll() const;
+    void clear();
+
+    // Periodic memory check for clipboards (server thread)
+    void start();
+    void stop();
+
+    // Spill or drop clipboards, least recently used first, until the total is under
+    // clipboardMemoryLimitMB; clipboards idle for clipboardIdleMinutes go regardless.
+    void enforceMemoryLimit();
+
+    // Bring a session's spilled clipboard back on a worker and hand it to `onRestored` on the server
+    // thread (nullptr if it cannot be read). A resident clipboard is handed over at once. The restored
+    // bytes count against the limit again, so a burst of restores evicts others.
+    void restoreClipboard(std::shared_ptr<PlayerSession> session, PlayerSession::RestoreCallback onRestored);
+
+    // Resident clipboard bytes over all sessions
+    size_t getClipboardMemory() const;
+
+    std::filesystem::path getSpillDir() const;
+
+private:
+    using SessionMap = std::unordered_map<PlayerId, std::shared_ptr<PlayerSession>, PlayerIdHash>;
+
+    std::atomic<std::shared_ptr<const SessionMap>> mSessions{std::make_shared<const SessionMap>()};
+    std::mutex mWriteMutex;
+    uint64_t mGeneration = 0; // Bumped on stop so a stale maintenance loop exits
+    bool mRunning = false;
+};
+
+} // namespace wooden_axe
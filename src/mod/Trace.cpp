@@ -0,0 +1,220 @@
+#include "mod/Trace.h"
+#include "mod/Log.h"
+#include "mod/WorkerPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+namespace wooden_axe {
+
+namespace {
+
+struct LaneZones {
+    uint32_t id;
+    std::string name;
+    std::vector<const char*> names;
+    std::vector<int64_t> begins;
+    std::vector<int64_t> ends;
+};
+
+// JSON string body; labels come from file names
+std::string escapeJson(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// "paste 10x5x10 at (1, 2, 3)" -> "paste-10x5x10-at-1-2-3"
+std::string toFileStem(const std::string& label) {
+    std::string stem;
+    for (char c : label) {
+        bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '_';
+        if (keep) {
+            stem += c;
+        } else if (!stem.empty() && stem.back() != '-') {
+            stem += '-';
+        }
+    }
+    while (!stem.empty() && stem.back() == '-') {
+        stem.pop_back();
+    }
+    return stem.substr(0, 64);
+}
+
+bool writeTrace(const std::filesystem::path& path, const std::string& label, const std::vector<LaneZones>& lanes) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"label\":\"" << escapeJson(label) << "\"},\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"WoodenAxe\"}}";
+    for (const auto& lane : lanes) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << lane.id
+            << ",\"args\":{\"name\":\"" << escapeJson(lane.name) << "\"}}";
+        out << ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << lane.id
+            << ",\"args\":{\"sort_index\":" << lane.id << "}}";
+        for (size_t i = 0; i < lane.names.size(); i++) {
+            out << ",\n{\"name\":\"" << lane.names[i] << "\",\"cat\":\"wa\",\"ph\":\"X\",\"pid\":1,\"tid\":" << lane.id
+                << ",\"ts\":" << lane.begins[i] << ",\"dur\":" << lane.ends[i] - lane.begins[i] << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+bool Tracer::setEnabled(bool enabled) {
+    if (enabled && !kCompiledIn) {
+        return false;
+    }
+    if (enabled) {
+        auto& lane = getLane();
+        std::lock_guard lock(lane.mutex);
+        lane.name = "server";
+    }
+    mEnabled.store(enabled);
+    return true;
+}
+
+Tracer::ThreadLane& Tracer::getLane() {
+    thread_local std::shared_ptr<ThreadLane> tLane;
+    if (!tLane) {
+        tLane = std::make_shared<ThreadLane>();
+        std::lock_guard lock(mMutex);
+        tLane->id = static_cast<uint32_t>(mLanes.size() + 1);
+        tLane->name = "worker " + std::to_string(tLane->id);
+        mLanes.push_back(tLane);
+    }
+    return *tLane;
+}
+
+void Tracer::record(const char* name, int64_t beginUs, int64_t endUs) {
+    auto& lane = getLane();
+    std::lock_guard lock(lane.mutex);
+    lane.zones.push_back({name, beginUs, endUs});
+}
+
+uint64_t Tracer::beginCapture(std::string label) {
+    if (!isEnabled()) {
+        return 0;
+    }
+    std::lock_guard lock(mMutex);
+    uint64_t id = mNextCaptureId++;
+    mCaptures.push_back({id, std::move(label), now()});
+    mOpenCaptures.fetch_add(1);
+    return id;
+}
+
+void Tracer::endCapture(uint64_t id) {
+    if (id == 0) {
+        return;
+    }
+    int64_t endUs = now();
+
+    std::string label;
+    std::vector<LaneZones> lanes;
+    {
+        std::lock_guard lock(mMutex);
+        auto it = std::find_if(mCaptures.begin(), mCaptures.end(), [id](const Capture& c) { return c.id == id; });
+        if (it == mCaptures.end()) {
+            return; // Cleared meanwhile
+        }
+        label = std::move(it->label);
+        int64_t beginUs = it->beginUs;
+        mCaptures.erase(it);
+        mOpenCaptures.fetch_sub(1);
+
+        // Zones older than every capture still open can go
+        int64_t keepFrom = endUs;
+        for (const auto& capture : mCaptures) {
+            keepFrom = std::min(keepFrom, capture.beginUs);
+        }
+
+        for (const auto& lane : mLanes) {
+            std::lock_guard laneLock(lane->mutex);
+            LaneZones copy{lane->id, lane->name, {}, {}, {}};
+            for (const auto& zone : lane->zones) {
+                if (zone.beginUs >= beginUs && zone.endUs <= endUs) {
+                    copy.names.push_back(zone.name);
+                    copy.begins.push_back(zone.beginUs);
+                    copy.ends.push_back(zone.endUs);
+                }
+            }
+            if (mCaptures.empty()) {
+                lane->zones.clear();
+            } else {
+                std::erase_if(lane->zones, [keepFrom](const Zone& zone) { return zone.beginUs < keepFrom; });
+            }
+            if (!copy.names.empty()) {
+                lanes.push_back(std::move(copy));
+            }
+        }
+    }
+
+    // Serializing can take a while for a large paste; keep it off the server thread
+    auto dir = getTraceDir();
+    WorkerPool::getInstance().submit([dir, id, label = std::move(label), lanes = std::move(lanes)] {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+
+        // std::localtime shares one buffer between threads
+        char stamp[32];
+        std::time_t time = std::time(nullptr);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+        auto path = dir / (std::string(stamp) + "-" + std::to_string(id) + "-" + toFileStem(label) + ".json");
+
+        size_t zones = 0;
+        for (const auto& lane : lanes) {
+            zones += lane.names.size();
+        }
+        if (writeTrace(path, label, lanes)) {
+            Log::info("Trace of {} written to {} ({} zones on {} threads)", label, path.string(), zones,
+                      lanes.size());
+        } else {
+            Log::error("Failed to write trace to {}", path.string());
+        }
+    });
+}
+
+void Tracer::clear() {
+    std::lock_guard lock(mMutex);
+    mOpenCaptures.fetch_sub(static_cast<int>(mCaptures.size()));
+    mCaptures.clear();
+    for (const auto& lane : mLanes) {
+        std::lock_guard laneLock(lane->mutex);
+        lane->zones.clear();
+    }
+}
+
+void Tracer::setTraceDir(std::filesystem::path dir) {
+    std::lock_guard lock(mMutex);
+    mTraceDir = std::move(dir);
+}
+
+std::filesystem::path Tracer::getTraceDir() const {
+    std::lock_guard lock(mMutex);
+    return mTraceDir;
+}
+
+} // namespace wooden_axe
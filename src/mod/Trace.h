@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wooden_axe {
+
+// Scoped profiling zones saved as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev),
+// one file per load or paste, with a lane per thread. Zones compile to nothing unless the
+// plugin is built with WA_TRACE (xmake f --trace=y); /watrace on then starts recording.
+class Tracer {
+public:
+    static Tracer& getInstance() {
+        static Tracer instance;
+        return instance;
+    }
+
+#ifdef WA_TRACE
+    static constexpr bool kCompiledIn = true;
+#else
+    static constexpr bool kCompiledIn = false;
+#endif
+
+    // Turning tracing on names the calling thread's lane "server"
+    bool setEnabled(bool enabled);
+    bool isEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+    // Zones are only kept while a capture is open
+    bool isRecording() const { return mOpenCaptures.load(std::memory_order_relaxed) > 0; }
+
+    // Open a capture for one load or paste (0 when tracing is off). Ending it writes every zone
+    // recorded meanwhile, on any thread, to a file in the background.
+    uint64_t beginCapture(std::string label);
+    void endCapture(uint64_t id);
+
+    // Drop open captures and recorded zones
+    void clear();
+
+    // Where endCapture writes; WoodenAxeMod points it at <data dir>/traces
+    void setTraceDir(std::filesystem::path dir);
+    std::filesystem::path getTraceDir() const;
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mEpoch)
+            .count();
+    }
+
+    void record(const char* name, int64_t beginUs, int64_t endUs);
+
+private:
+    struct Zone {
+        const char* name;
+        int64_t beginUs;
+        int64_t endUs;
+    };
+
+    // Zones of one thread; appends only contend with a capture being written
+    struct ThreadLane {
+        uint32_t id = 0;
+        std::string name;
+        std::mutex mutex;
+        std::vector<Zone> zones;
+    };
+
+    struct Capture {
+        uint64_t id;
+        std::string label;
+        int64_t beginUs;
+    };
+
+    ThreadLane& getLane();
+
+    const std::chrono::steady_clock::time_point mEpoch = std::chrono::steady_clock::now();
+    std::atomic<bool> mEnabled{false};
+    std::atomic<int> mOpenCaptures{0};
+
+    mutable std::mutex mMutex; // Guards the fields below
+    std::vector<std::shared_ptr<ThreadLane>> mLanes;
+    std::vector<Capture> mCaptures;
+    uint64_t mNextCaptureId = 1;
+    std::filesystem::path mTraceDir = "traces";
+};
+
+// Records the time from construction to destruction as one zone, if a capture is open
+class TraceZone {
+public:
+    explicit TraceZone(const char* name)
+    : mName(name),
+      mBeginUs(Tracer::getInstance().isRecording() ? Tracer::getInstance().now() : -1) {}
+
+    ~TraceZone() {
+        if (mBeginUs >= 0) {
+            Tracer::getInstance().record(mName, mBeginUs, Tracer::getInstance().now());
+        }
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* mName;
+    int64_t mBeginUs;
+};
+
+// A capture spanning one scope
+class TraceCapture {
+public:
+    explicit TraceCapture(std::string label) : mId(Tracer::getInstance().beginCapture(std::move(label))) {}
+    ~TraceCapture() { Tracer::getInstance().endCapture(mId); }
+
+    TraceCapture(const TraceCapture&) = delete;
+    TraceCapture& operator=(const TraceCapture&) = delete;
+
+private:
+    uint64_t mId;
+};
+
+} // namespace wooden_axe
+
+#ifdef WA_TRACE
+#define WA_TRACE_CONCAT_(a, b) a##b
+#define WA_TRACE_CONCAT(a, b) WA_TRACE_CONCAT_(a, b)
+#define WA_TRACE_ZONE(name) ::wooden_axe::TraceZone WA_TRACE_CONCAT(waTraceZone, __LINE__)(name)
+#else
+#define WA_TRACE_ZONE(name) ((void)0)
+#endif
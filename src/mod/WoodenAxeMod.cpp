@@ -1,13 +1,40 @@
 #include "mod/WoodenAxeMod.h"
 #include "mod/Commands.h"
 #include "mod/EventHandlers.h"
-
+#include "mod/SessionStore.h"
+#include "mod/JobScheduler.h"
+#include "mod/Log.h"
+#include "mod/WorkerPool.h"
+#include "mod/SchematicCache.h"
+#include "mod/Trace.h"
+
+#include "ll/api/Config.h"
+#include "ll/api/chrono/GameChrono.h"
+#include "ll/api/coro/CoroTask.h"
 #include "ll/api/mod/RegisterHelper.h"
+#include "ll/api/thread/ServerThreadExecutor.h"
 
 #include <filesystem>
 
 namespace wooden_axe {
 
+using namespace ll::chrono_literals;
+
+// Tick the job scheduler on the server thread until it is stopped or started again
+static void launchJobLoop() {
+    uint64_t generation = JobScheduler::getInstance().getGeneration();
+    ll::coro::keepThis([generation]() -> ll::coro::CoroTask<> {
+        auto& scheduler = JobScheduler::getInstance();
+        while (scheduler.isRunning() && scheduler.getGeneration() == generation) {
+            co_await 1_tick;
+            if (scheduler.getGeneration() != generation) {
+                break;
+            }
+            scheduler.tick();
+        }
+    }).launch(ll::thread::ServerThreadExecutor::getDefault());
+}
+
 WoodenAxeMod& WoodenAxeMod::getInstance() {
     static WoodenAxeMod instance;
     return instance;
@@ -27,6 +54,16 @@ bool WoodenAxeMod::load() {
     logger.info("  A simple schematic loader for LeviLamina");
     logger.info("");
 
+    // Load config, writing defaults on first run
+    const auto& configFilePath = getSelf().getConfigDir() / "config.json";
+    if (!ll::config::loadConfig(mConfig, configFilePath)) {
+        logger.warn("Cannot load configurations from {}", configFilePath.string());
+        logger.info("Saving default configurations");
+        if (!ll::config::saveConfig(mConfig, configFilePath)) {
+            logger.error("Cannot save default configurations to {}", configFilePath.string());
+        }
+    }
+
     // Create schematic directory if not exists
     auto schematicPath = std::filesystem::path(getSelf().getDataDir().string()) / "schematics";
     if (!std::filesystem::exists(schematicPath)) {
@@ -42,12 +79,45 @@ bool WoodenAxeMod::enable() {
     auto& logger = getSelf().getLogger();
     logger.info("Enabling WoodenAxe...");
 
+    // The reader and tracer log through Log so they can also run in the bench harness
+    Log::setHandler([&logger](LogLevel level, const std::string& message) {
+        switch (level) {
+        case LogLevel::Debug:
+            logger.debug("{}", message);
+            break;
+        case LogLevel::Info:
+            logger.info("{}", message);
+            break;
+        case LogLevel::Warn:
+            logger.warn("{}", message);
+            break;
+        case LogLevel::Error:
+            logger.error("{}", message);
+            break;
+        }
+    });
+    Tracer::getInstance().setTraceDir(getSelf().getDataDir() / "traces");
+
+    // Start background workers for placement planning
+    WorkerPool::getInstance().start();
+    logger.info("Worker pool started with {} threads", WorkerPool::getInstance().getThreadCount());
+    
+    // Start the per-tick job loop
+    JobScheduler::getInstance().start(makeSchedulerSettings(mConfig));
+    launchJobLoop();
+    
+    // Start the clipboard memory check
+    SessionStore::getInstance().start();
+
     // Register event handlers
     registerEventHandlers();
     
     // Register commands
     registerCommands();
 
+    // Load the configured schematics in the background; startup does not wait for them
+    SchematicCache::getInstance().prewarm(mConfig.prewarmSchematics, getSchematicDir());
+
     logger.info("WoodenAxe enabled!");
     return true;
 }
@@ -57,36 +127,19 @@ bool WoodenAxeMod::disable() {
     logger.info("Disabling WoodenAxe...");
 
     // Cleanup
-    mSelections.clear();
+    JobScheduler::getInstance().stop();
+    SessionStore::getInstance().stop();
+    WorkerPool::getInstance().stop();
+    SessionStore::getInstance().clear();
+    SchematicCache::getInstance().clear();
+    Tracer::getInstance().setEnabled(false);
+    Tracer::getInstance().clear();
+    Log::setHandler(nullptr);
 
     logger.info("WoodenAxe disabled!");
     return true;
 }
 
-void WoodenAxeMod::setPos1(const std::string& playerName, const BlockPos& pos, int dim) {
-    auto& sel = mSelections[playerName];
-    sel.pos1 = pos;
-    sel.dimension = dim;
-}
-
-void WoodenAxeMod::setPos2(const std::string& playerName, const BlockPos& pos, int dim) {
-    auto& sel = mSelections[playerName];
-    sel.pos2 = pos;
-    sel.dimension = dim;
-}
-
-std::optional<PlayerSelection> WoodenAxeMod::getSelection(const std::string& playerName) const {
-    auto it = mSelections.find(playerName);
-    if (it != mSelections.end()) {
-        return it->second;
-    }
-    return std::nullopt;
-}
-
-void WoodenAxeMod::clearSelection(const std::string& playerName) {
-    mSelections.erase(playerName);
-}
-
 std::string WoodenAxeMod::getSchematicDir() const {
     return (std::filesystem::path(getSelf().getDataDir().string()) / "schematics").string();
 }
@@ -1,23 +1,31 @@
 #pragma once
 
+#include "mod/BlockBox.h"
+#include "mod/Config.h"
+
 #include "ll/api/mod/NativeMod.h"
+#include <algorithm>
 #include <memory>
-#include <unordered_map>
 #include <string>
 #include <optional>
 
 namespace wooden_axe {
 
-// Forward declarations
-struct BlockPos {
-    int x, y, z;
-    BlockPos(int x = 0, int y = 0, int z = 0) : x(x), y(y), z(z) {}
-};
-
 struct PlayerSelection {
     std::optional<BlockPos> pos1;
     std::optional<BlockPos> pos2;
     int dimension = 0;
+    
+    // Box spanned by pos1 and pos2, if both are set
+    std::optional<BlockBox> getBox() const {
+        if (!pos1 || !pos2) {
+            return std::nullopt;
+        }
+        return BlockBox{
+            BlockPos(std::min(pos1->x, pos2->x), std::min(pos1->y, pos2->y), std::min(pos1->z, pos2->z)),
+            BlockPos(std::max(pos1->x, pos2->x), std::max(pos1->y, pos2->y), std::max(pos1->z, pos2->z))
+        };
+    }
 };
 
 class WoodenAxeMod {
@@ -32,18 +40,13 @@ public:
     bool enable();
     bool disable();
 
-    // Selection management
-    void setPos1(const std::string& playerName, const BlockPos& pos, int dim);
-    void setPos2(const std::string& playerName, const BlockPos& pos, int dim);
-    std::optional<PlayerSelection> getSelection(const std::string& playerName) const;
-    void clearSelection(const std::string& playerName);
-
     // Config
     std::string getSchematicDir() const;
+    [[nodiscard]] const Config& getConfig() const { return mConfig; }
 
 private:
     ll::mod::NativeMod& mSelf;
-    std::unordered_map<std::string, PlayerSelection> mSelections;
+    Config mConfig;
 };
 
 } // namespace wooden_axe
@@ -0,0 +1,130 @@
+#include "mod/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace wooden_axe {
+
+void WorkerPool::start(size_t threadCount) {
+    if (!mThreads.empty()) {
+        return;
+    }
+
+    if (threadCount == 0) {
+        size_t hw = std::thread::hardware_concurrency();
+        threadCount = std::max<size_t>(1, hw > 1 ? hw - 1 : 1);
+    }
+
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = false;
+    }
+
+    mThreads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        mThreads.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+        mTasks.clear();
+    }
+    mCondition.notify_all();
+
+    for (auto& thread : mThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    mThreads.clear();
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    if (mThreads.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard lock(mMutex);
+        mTasks.push_back(std::move(task));
+    }
+    mCondition.notify_one();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    // Shared with helpers that may only get scheduled after the caller has returned
+    struct State {
+        std::function<void(size_t)> fn;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error; // First one thrown, guarded by mutex
+    };
+
+    auto state = std::make_shared<State>();
+    state->fn = fn;
+    state->count = count;
+
+    auto drain = [](State& s) {
+        size_t i;
+        while ((i = s.next.fetch_add(1)) < s.count) {
+            // A throwing item still counts as done, or the caller would wait forever
+            try {
+                s.fn(i);
+            } catch (...) {
+                std::lock_guard lock(s.mutex);
+                if (!s.error) {
+                    s.error = std::current_exception();
+                }
+            }
+            if (s.done.fetch_add(1) + 1 == s.count) {
+                std::lock_guard lock(s.mutex);
+                s.finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(getThreadCount(), count - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit([state, drain] { drain(*state); });
+    }
+
+    // Every claimed item belongs to a running thread, so this never waits on queued helpers
+    drain(*state);
+
+    std::unique_lock lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == state->count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mMutex);
+            mCondition.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+            if (mStopping) {
+                return;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace wooden_axe
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wooden_axe {
+
+// Background threads for CPU-only work (never touches the world)
+class WorkerPool {
+public:
+    static WorkerPool& getInstance() {
+        static WorkerPool instance;
+        return instance;
+    }
+
+    // Start worker threads (0 = hardware concurrency - 1)
+    void start(size_t threadCount = 0);
+
+    // Stop and join all workers, dropping queued tasks
+    void stop();
+
+    // Queue a task; runs inline if the pool is not started
+    void submit(std::function<void()> task);
+
+    // Run fn(i) for every i in [0, count), the calling thread participates.
+    // Safe to call from inside a pool task. Every item runs even if some throw; the first
+    // exception is then rethrown on the calling thread.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t getThreadCount() const { return mThreads.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> mThreads;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopping = false;
+};
+
+} // namespace wooden_axe
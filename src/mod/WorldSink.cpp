@@ -0,0 +1,24 @@
+#include "mod/WorldSink.h"
+
+#include <stdexcept>
+
+namespace wooden_axe {
+
+size_t WorldSink::writeSection(int chunkX, int chunkZ, const BlockCommand* commands,
+                               const std::vector<const Block*>& blocks) {
+    size_t written = 0;
+    for (size_t i = 0; i < ChunkCommandBuffer::kSectionVolume; i++) {
+        const auto& command = commands[i];
+        try {
+            if (setBlock(chunkX * 16 + command.localX(), command.worldY(), chunkZ * 16 + command.localZ(),
+                         *blocks[command.blockIndex], false)) {
+                written++;
+            }
+        } catch (const std::exception&) {
+            // Counted as failed by the caller
+        }
+    }
+    return written;
+}
+
+} // namespace wooden_axe
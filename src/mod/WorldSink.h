@@ -0,0 +1,60 @@
+#pragma once
+
+#include "mod/PlacementPlan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Block;
+
+namespace wooden_axe {
+
+// Everything the paste pipeline needs from a world. The server goes through
+// BlockSource (makeDimensionSink, DimensionSink.cpp); MemoryWorldSink keeps chunks in memory so
+// plans can be written and measured without one. The blocks a sink hands out are handles only
+// that sink looks into: ask it (getBlockId, getBlockTypeName) instead of calling into the Block.
+// Used from one thread at a time.
+class WorldSink {
+public:
+    virtual ~WorldSink() = default;
+
+    // Block for a full registry name ("minecraft:stone"), nullptr if unknown
+    virtual const Block* resolveBlock(const std::string& name) = 0;
+
+    // Dense id of a block state from this sink (the runtime id on a server)
+    virtual uint32_t getBlockId(const Block& block) const = 0;
+
+    // Registry name of a block's type, without states ("minecraft:stone")
+    virtual std::string getBlockTypeName(const Block& block) const = 0;
+
+    // Start loading a chunk without blocking; false if the world is unavailable.
+    // A requested chunk stays loaded until released.
+    virtual bool requestChunk(int chunkX, int chunkZ) = 0;
+    virtual bool isChunkReady(int chunkX, int chunkZ) = 0;
+    virtual void releaseChunk(int chunkX, int chunkZ) = 0;
+
+    // Reads and writes between beginChunk and endChunk stay in that chunk column.
+    // beginChunk returns false if the world is unavailable, setBlock if the write did not
+    // happen. Blocks written without client updates are announced by endChunk in one update
+    // per changed subchunk; it returns how many it sent.
+    virtual bool beginChunk(int chunkX, int chunkZ) = 0;
+    virtual const Block* getBlock(int x, int y, int z) = 0;
+    virtual bool setBlock(int x, int y, int z, const Block& block, bool updateClients) = 0;
+    virtual size_t endChunk() = 0;
+
+    // Write one whole 16x16x16 section of the open chunk: kSectionVolume commands of a
+    // plan whose palette is `blocks`. Always refreshed by endChunk. Returns blocks written.
+    virtual size_t writeSection(int chunkX, int chunkZ, const BlockCommand* commands,
+                                const std::vector<const Block*>& blocks);
+
+    // Load Bedrock NBT into the block actor at a position; false if there is none or the data is invalid
+    virtual bool loadBlockEntity(int x, int y, int z, const std::string& nbt) = 0;
+};
+
+// The server's dimension, written through its main BlockSource (server thread only)
+std::shared_ptr<WorldSink> makeDimensionSink(int dimension);
+
+} // namespace wooden_axe
@@ -24,6 +24,13 @@ option("target_type")
     set_values("server", "client")
 option_end()
 
+-- Profiling zones for /watrace; compiled out unless enabled
+option("trace")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile in Chrome trace zones for /watrace")
+option_end()
+
 target("wooden-axe")
     add_rules("@levibuildscript/linkrule")
     add_rules("@levibuildscript/modpacker")
@@ -42,3 +49,6 @@ target("wooden-axe")
     else
         add_defines("LL_PLAT_C")
     end
+    if has_config("trace") then
+        add_defines("WA_TRACE")
+    end